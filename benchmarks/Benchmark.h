@@ -0,0 +1,141 @@
+#ifndef GCODELIB_BENCHMARKS_BENCHMARK_H_
+#define GCODELIB_BENCHMARKS_BENCHMARK_H_
+
+#include "Counters.h"
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace GCodeBench {
+
+  template <typename T>
+  inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static const void *volatile sink;
+    sink = &value;
+#endif
+  }
+
+  class Measurement {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    template <typename F>
+    void run(F fn) {
+      std::size_t iterations = 1;
+      while (true) {
+        HardwareCounters &counters = HardwareCounters::get();
+        counters.start();
+        auto start = Clock::now();
+        for (std::size_t i = 0; i < iterations; i++) {
+          fn();
+        }
+        auto elapsed = Clock::now() - start;
+        auto sample = counters.stop();
+        if (elapsed >= MinimalDuration || iterations >= MaximalIterations) {
+          this->iterations = iterations;
+          this->duration = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+          this->counters = sample;
+          return;
+        }
+        iterations *= 2;
+      }
+    }
+
+    void setItems(std::size_t items) {
+      this->items = items;
+    }
+
+    void setBytes(std::size_t bytes) {
+      this->bytes = bytes;
+    }
+
+    std::size_t getIterations() const {
+      return this->iterations;
+    }
+
+    std::size_t getItems() const {
+      return this->items;
+    }
+
+    std::size_t getBytes() const {
+      return this->bytes;
+    }
+
+    std::chrono::nanoseconds getDuration() const {
+      return this->duration;
+    }
+
+    double getNanosecondsPerIteration() const {
+      return this->iterations > 0
+        ? static_cast<double>(this->duration.count()) / this->iterations
+        : 0.0;
+    }
+
+    double getItemsPerSecond() const {
+      return this->duration.count() > 0
+        ? static_cast<double>(this->items) * this->iterations * 1e9 / this->duration.count()
+        : 0.0;
+    }
+
+    double getBytesPerSecond() const {
+      return this->duration.count() > 0
+        ? static_cast<double>(this->bytes) * this->iterations * 1e9 / this->duration.count()
+        : 0.0;
+    }
+
+    std::optional<double> getCounterPerIteration(std::size_t counter) const {
+      if (counter >= HardwareCounters::Count || !this->counters[counter].has_value() || this->iterations == 0) {
+        return std::optional<double>();
+      }
+      return this->counters[counter].value() / this->iterations;
+    }
+
+    std::optional<double> getInstructionsPerCycle() const {
+      const auto &instructions = this->counters[HardwareCounters::Instructions];
+      const auto &cycles = this->counters[HardwareCounters::Cycles];
+      if (!instructions.has_value() || !cycles.has_value() || cycles.value() <= 0.0) {
+        return std::optional<double>();
+      }
+      return instructions.value() / cycles.value();
+    }
+
+    static constexpr std::chrono::milliseconds MinimalDuration{200};
+    static constexpr std::size_t MaximalIterations = 1 << 30;
+   private:
+    std::size_t iterations = 0;
+    std::size_t items = 1;
+    std::size_t bytes = 0;
+    std::chrono::nanoseconds duration{0};
+    HardwareCounters::Sample counters;
+  };
+
+  using BenchmarkFn = void (*)(Measurement &);
+
+  struct BenchmarkCase {
+    std::string name;
+    BenchmarkFn fn;
+  };
+
+  std::vector<BenchmarkCase> &registry();
+
+  class Registrar {
+   public:
+    Registrar(const char *name, BenchmarkFn fn) {
+      registry().push_back(BenchmarkCase { name, fn });
+    }
+  };
+}
+
+#define GCODEBENCH_CONCAT_IMPL(a, b) a##b
+#define GCODEBENCH_CONCAT(a, b) GCODEBENCH_CONCAT_IMPL(a, b)
+#define GCODEBENCH_CASE_IMPL(name, fn) \
+  static void fn(GCodeBench::Measurement &); \
+  static GCodeBench::Registrar GCODEBENCH_CONCAT(fn, _registrar)(name, fn); \
+  static void fn(GCodeBench::Measurement &bench)
+#define BENCHMARK_CASE(name) GCODEBENCH_CASE_IMPL(name, GCODEBENCH_CONCAT(gcodebench_case_, __LINE__))
+
+#endif
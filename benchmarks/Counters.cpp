@@ -0,0 +1,142 @@
+#include "Counters.h"
+#include <cstring>
+#include <cerrno>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace GCodeBench {
+
+  bool HardwareCounters::disabled = false;
+
+#ifdef __linux__
+  static int open_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  HardwareCounters::HardwareCounters() {
+    this->descriptors.fill(-1);
+    if (HardwareCounters::disabled) {
+      this->error = "disabled";
+      return;
+    }
+    static const std::pair<uint32_t, uint64_t> Events[Count] = {
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+      { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+    };
+    // Counters are opened independently rather than as a group, so events the PMU cannot
+    // schedule together are multiplexed and scaled instead of failing as a whole
+    for (std::size_t i = 0; i < Count; i++) {
+      this->descriptors[i] = open_counter(Events[i].first, Events[i].second);
+      if (this->descriptors[i] < 0 && this->error.empty()) {
+        this->error = std::strerror(errno);
+      }
+    }
+  }
+
+  HardwareCounters::~HardwareCounters() {
+    for (int fd : this->descriptors) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  }
+
+  bool HardwareCounters::isAvailable() const {
+    for (int fd : this->descriptors) {
+      if (fd >= 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void HardwareCounters::start() {
+    for (int fd : this->descriptors) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  HardwareCounters::Sample HardwareCounters::stop() {
+    for (int fd : this->descriptors) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+    Sample sample;
+    for (std::size_t i = 0; i < Count; i++) {
+      uint64_t values[3];
+      if (this->descriptors[i] < 0 ||
+        read(this->descriptors[i], values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) ||
+        values[2] == 0) {
+        continue;
+      }
+      sample[i] = static_cast<double>(values[0]) * values[1] / values[2];
+    }
+    return sample;
+  }
+#else
+  HardwareCounters::HardwareCounters()
+    : error("not supported on this platform") {
+    this->descriptors.fill(-1);
+  }
+
+  HardwareCounters::~HardwareCounters() = default;
+
+  bool HardwareCounters::isAvailable() const {
+    return false;
+  }
+
+  void HardwareCounters::start() {}
+
+  HardwareCounters::Sample HardwareCounters::stop() {
+    return Sample{};
+  }
+#endif
+
+  const std::string &HardwareCounters::getError() const {
+    return this->error;
+  }
+
+  const char *HardwareCounters::getName(std::size_t counter) {
+    static const char *Names[Count] = {
+      "cycles",
+      "instructions",
+      "cache_references",
+      "cache_misses",
+      "l1d_read_misses",
+      "branches",
+      "branch_misses"
+    };
+    return counter < Count ? Names[counter] : "";
+  }
+
+  HardwareCounters &HardwareCounters::get() {
+    static HardwareCounters counters;
+    return counters;
+  }
+
+  void HardwareCounters::disable() {
+    HardwareCounters::disabled = true;
+  }
+}
\ No newline at end of file
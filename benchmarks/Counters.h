@@ -0,0 +1,48 @@
+#ifndef GCODELIB_BENCHMARKS_COUNTERS_H_
+#define GCODELIB_BENCHMARKS_COUNTERS_H_
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace GCodeBench {
+
+  // Per-thread hardware counters via perf_event_open; unavailable counters read as empty
+  class HardwareCounters {
+   public:
+    enum Counter {
+      Cycles = 0,
+      Instructions,
+      CacheReferences,
+      CacheMisses,
+      L1DataMisses,
+      Branches,
+      BranchMisses,
+      Count
+    };
+
+    using Sample = std::array<std::optional<double>, Count>;
+
+    HardwareCounters(const HardwareCounters &) = delete;
+    HardwareCounters &operator=(const HardwareCounters &) = delete;
+    ~HardwareCounters();
+
+    bool isAvailable() const;
+    const std::string &getError() const;
+    void start();
+    Sample stop();
+
+    static const char *getName(std::size_t);
+    static HardwareCounters &get();
+    static void disable();
+   private:
+    HardwareCounters();
+
+    std::array<int, Count> descriptors;
+    std::string error;
+    static bool disabled;
+  };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef GCODELIB_BENCHMARKS_FIXTURES_H_
+#define GCODELIB_BENCHMARKS_FIXTURES_H_
+
+#include "Benchmark.h"
+#include "gcodelib/runtime/Interpreter.h"
+
+namespace GCodeBench {
+
+  class GCodeBenchInterpreter : public GCodeLib::Runtime::GCodeInterpreter {
+   public:
+    GCodeBenchInterpreter(const GCodeLib::Runtime::GCodeIRModule &module)
+      : GCodeInterpreter(module), systemScope(numbered, named) {}
+
+    std::size_t getSyscallCount() const {
+      return this->syscalls;
+    }
+   protected:
+    void syscall(GCodeLib::Runtime::GCodeSyscallType, const GCodeLib::Runtime::GCodeRuntimeValue &, const GCodeLib::Runtime::GCodeSyscallArguments &args) override {
+      doNotOptimize(args);
+      this->syscalls++;
+    }
+
+    void syscall(GCodeLib::Runtime::GCodeSyscallType, const GCodeLib::Runtime::GCodeRuntimeValue &, const GCodeLib::Runtime::GCodeScopedDictionary<unsigned char> &args) override {
+      doNotOptimize(args);
+      this->syscalls++;
+    }
+
+    GCodeLib::Runtime::GCodeVariableScope &getSystemScope() override {
+      return this->systemScope;
+    }
+   private:
+    GCodeLib::Runtime::GCodeVirtualDictionary<std::string> named;
+    GCodeLib::Runtime::GCodeVirtualDictionary<int64_t> numbered;
+    GCodeLib::Runtime::GCodeCustomVariableScope systemScope;
+    std::size_t syscalls = 0;
+  };
+}
+
+#endif
\ No newline at end of file
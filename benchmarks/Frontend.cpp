@@ -0,0 +1,153 @@
+#include "Fixtures.h"
+#include "gcodelib/Frontend.h"
+#include "gcodelib/runtime/Interpreter.h"
+#include <sstream>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+static constexpr std::size_t ProgramLines = 2000;
+
+static std::string make_reprap() {
+  std::stringstream source;
+  for (std::size_t i = 0; i < ProgramLines; i++) {
+    source << "G1 X" << (i % 200) * 0.1 << " Y" << (i % 150) * 0.2
+      << " Z0.3 E" << i * 0.01 << " F1800 ; move " << i << std::endl;
+  }
+  return source.str();
+}
+
+static std::string make_linuxcnc() {
+  std::stringstream source;
+  source << "o100 sub" << std::endl
+    << "G1 X[#0 * 0.1] Y[#0 MOD 150 * 0.2] F1800" << std::endl
+    << "o100 endsub" << std::endl;
+  for (std::size_t i = 0; i < ProgramLines; i++) {
+    switch (i % 4) {
+      case 0:
+        source << "#<depth> = [" << i << " * 0.01 + 0.3] (layer " << i << ")" << std::endl;
+        break;
+      case 1:
+        source << "G1 X" << (i % 200) * 0.1 << " Y" << (i % 150) * 0.2 << " Z#<depth> F1800" << std::endl;
+        break;
+      case 2:
+        source << "o100 call [" << i << "]" << std::endl;
+        break;
+      default:
+        source << "G0 X[#<depth> + 1] Y[[" << i << " - 2] / 3]" << std::endl;
+        break;
+    }
+  }
+  return source.str();
+}
+
+template <typename Scanner>
+static void scan(GCodeBench::Measurement &bench, const std::string &program) {
+  std::size_t tokens = 0;
+  {
+    std::stringstream source(program);
+    Scanner scanner(source);
+    while (scanner.next().has_value()) {
+      tokens++;
+    }
+  }
+  bench.setItems(tokens);
+  bench.setBytes(program.size());
+  bench.run([&]() {
+    std::stringstream source(program);
+    Scanner scanner(source);
+    while (true) {
+      auto token = scanner.next();
+      if (!token.has_value()) {
+        break;
+      }
+      GCodeBench::doNotOptimize(token);
+    }
+  });
+}
+
+template <typename Frontend>
+static void parse(GCodeBench::Measurement &bench, const std::string &program) {
+  Frontend frontend;
+  bench.setItems(ProgramLines);
+  bench.setBytes(program.size());
+  bench.run([&]() {
+    std::stringstream source(program);
+    auto ast = frontend.parse(source, "bench");
+    GCodeBench::doNotOptimize(ast);
+  });
+}
+
+template <typename Frontend>
+static void translate(GCodeBench::Measurement &bench, const std::string &program) {
+  Frontend frontend;
+  std::stringstream source(program);
+  auto ast = frontend.parse(source, "bench");
+  typename Frontend::ManglerType mangler;
+  GCodeIRTranslator translator(mangler);
+  bench.setItems(ProgramLines);
+  bench.run([&]() {
+    auto module = translator.translate(*ast);
+    GCodeBench::doNotOptimize(module);
+  });
+}
+
+BENCHMARK_CASE("Scanner/RepRap") {
+  scan<Parser::RepRap::GCodeDefaultScanner>(bench, make_reprap());
+}
+
+BENCHMARK_CASE("Scanner/LinuxCNC") {
+  scan<Parser::LinuxCNC::GCodeDefaultScanner>(bench, make_linuxcnc());
+}
+
+BENCHMARK_CASE("Parser/RepRap") {
+  parse<GCodeRepRap>(bench, make_reprap());
+}
+
+BENCHMARK_CASE("Parser/LinuxCNC") {
+  parse<GCodeLinuxCNC>(bench, make_linuxcnc());
+}
+
+BENCHMARK_CASE("Translator/RepRap") {
+  translate<GCodeRepRap>(bench, make_reprap());
+}
+
+BENCHMARK_CASE("Translator/LinuxCNC") {
+  translate<GCodeLinuxCNC>(bench, make_linuxcnc());
+}
+
+BENCHMARK_CASE("End-to-end/RepRap: compile and execute") {
+  std::string program = make_reprap();
+  GCodeRepRap frontend;
+  bench.setItems(ProgramLines);
+  bench.setBytes(program.size());
+  bench.run([&]() {
+    std::stringstream source(program);
+    auto module = frontend.compile(source, "bench");
+    GCodeBench::GCodeBenchInterpreter interp(*module);
+    interp.execute();
+    GCodeBench::doNotOptimize(interp.getSyscallCount());
+  });
+}
+
+BENCHMARK_CASE("End-to-end/LinuxCNC: compile and execute") {
+  std::string program = make_linuxcnc();
+  GCodeLinuxCNC frontend;
+  std::size_t commands = 0;
+  {
+    std::stringstream source(program);
+    auto module = frontend.compile(source, "bench");
+    GCodeBench::GCodeBenchInterpreter interp(*module);
+    interp.execute();
+    commands = interp.getSyscallCount();
+  }
+  bench.setItems(commands);
+  bench.setBytes(program.size());
+  bench.run([&]() {
+    std::stringstream source(program);
+    auto module = frontend.compile(source, "bench");
+    GCodeBench::GCodeBenchInterpreter interp(*module);
+    interp.execute();
+    GCodeBench::doNotOptimize(interp.getSyscallCount());
+  });
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "Benchmark.h"
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+namespace GCodeBench {
+
+  std::vector<BenchmarkCase> &registry() {
+    static std::vector<BenchmarkCase> cases;
+    return cases;
+  }
+}
+
+static constexpr auto OptionJSON = "--json";
+static constexpr auto OptionNoCounters = "--no-counters";
+
+static bool selected(const std::string &name, const std::vector<std::string> &filters) {
+  if (filters.empty()) {
+    return true;
+  }
+  for (const auto &filter : filters) {
+    if (name.find(filter) != std::string::npos) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void print_text(const std::string &name, const GCodeBench::Measurement &measurement) {
+  std::cout << std::left << std::setw(48) << name
+    << std::right << std::setw(14) << std::fixed << std::setprecision(1) << measurement.getNanosecondsPerIteration() << " ns/iter"
+    << std::setw(16) << std::setprecision(0) << measurement.getItemsPerSecond() << " items/s";
+  if (measurement.getBytes() > 0) {
+    std::cout << std::setw(10) << std::setprecision(1) << measurement.getBytesPerSecond() / 1e6 << " MB/s";
+  }
+  auto ipc = measurement.getInstructionsPerCycle();
+  if (ipc.has_value()) {
+    std::cout << std::setprecision(2) << "  IPC " << ipc.value();
+  }
+  auto branchMisses = measurement.getCounterPerIteration(GCodeBench::HardwareCounters::BranchMisses);
+  if (branchMisses.has_value()) {
+    std::cout << std::setprecision(0) << "  br-miss/iter " << branchMisses.value();
+  }
+  auto cacheMisses = measurement.getCounterPerIteration(GCodeBench::HardwareCounters::L1DataMisses);
+  if (cacheMisses.has_value()) {
+    std::cout << std::setprecision(0) << "  L1d-miss/iter " << cacheMisses.value();
+  }
+  std::cout << std::endl;
+}
+
+static void print_json_string(const std::string &str) {
+  std::cout << '\"';
+  for (char chr : str) {
+    if (chr == '\"' || chr == '\\') {
+      std::cout << '\\' << chr;
+    } else if (static_cast<unsigned char>(chr) < 0x20) {
+      std::cout << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(chr) << std::dec << std::setfill(' ');
+    } else {
+      std::cout << chr;
+    }
+  }
+  std::cout << '\"';
+}
+
+static void print_json(const std::string &name, const GCodeBench::Measurement &measurement, bool first) {
+  std::cout << (first ? "\n" : ",\n") << "    {\"name\": ";
+  print_json_string(name);
+  std::cout << std::fixed << std::setprecision(3)
+    << ", \"iterations\": " << measurement.getIterations()
+    << ", \"duration_ns\": " << measurement.getDuration().count()
+    << ", \"ns_per_iteration\": " << measurement.getNanosecondsPerIteration()
+    << ", \"items\": " << measurement.getItems()
+    << ", \"items_per_second\": " << measurement.getItemsPerSecond()
+    << ", \"bytes\": " << measurement.getBytes()
+    << ", \"bytes_per_second\": " << measurement.getBytesPerSecond()
+    << ", \"counters_per_iteration\": {";
+  bool firstCounter = true;
+  for (std::size_t i = 0; i < GCodeBench::HardwareCounters::Count; i++) {
+    auto value = measurement.getCounterPerIteration(i);
+    if (value.has_value()) {
+      std::cout << (firstCounter ? "" : ", ") << '\"' << GCodeBench::HardwareCounters::getName(i) << "\": " << value.value();
+      firstCounter = false;
+    }
+  }
+  std::cout << "}, \"ipc\": ";
+  auto ipc = measurement.getInstructionsPerCycle();
+  if (ipc.has_value()) {
+    std::cout << ipc.value();
+  } else {
+    std::cout << "null";
+  }
+  std::cout << "}";
+}
+
+int main(int argc, const char **argv) {
+  bool json = false;
+  std::vector<std::string> filters;
+  for (int i = 1; i < argc; i++) {
+    if (std::string(argv[i]).compare(OptionJSON) == 0) {
+      json = true;
+    } else if (std::string(argv[i]).compare(OptionNoCounters) == 0) {
+      GCodeBench::HardwareCounters::disable();
+    } else {
+      filters.push_back(argv[i]);
+    }
+  }
+  if (!GCodeBench::HardwareCounters::get().isAvailable()) {
+    std::cerr << "Hardware counters unavailable: " << GCodeBench::HardwareCounters::get().getError() << std::endl;
+  }
+  if (json) {
+    std::cout << "{\n  \"benchmarks\": [";
+  }
+  bool first = true;
+  for (const auto &benchmark : GCodeBench::registry()) {
+    if (!selected(benchmark.name, filters)) {
+      continue;
+    }
+    GCodeBench::Measurement measurement;
+    benchmark.fn(measurement);
+    if (json) {
+      print_json(benchmark.name, measurement, first);
+    } else {
+      print_text(benchmark.name, measurement);
+    }
+    first = false;
+  }
+  if (json) {
+    std::cout << "\n  ]\n}" << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,44 @@
+#include "Fixtures.h"
+#include "gcodelib/Frontend.h"
+#include "gcodelib/runtime/Bytecode.h"
+#include <sstream>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+static constexpr std::size_t ProgramLines = 20000;
+
+static std::string make_program() {
+  std::stringstream source;
+  for (std::size_t i = 0; i < ProgramLines; i++) {
+    source << "G1 X" << (i % 200) * 0.1 << " Y" << (i % 150) * 0.2
+      << " Z0.3 E" << i * 0.01 << " F1800" << std::endl;
+  }
+  return source.str();
+}
+
+BENCHMARK_CASE("Bytecode/Compile from source") {
+  std::string program = make_program();
+  bench.setItems(ProgramLines);
+  bench.run([&]() {
+    std::stringstream source(program);
+    GCodeRepRap compiler;
+    auto module = compiler.compile(source, "bench");
+    GCodeBench::doNotOptimize(module);
+  });
+}
+
+BENCHMARK_CASE("Bytecode/Load binary image") {
+  std::stringstream source(make_program());
+  GCodeRepRap compiler;
+  auto module = compiler.compile(source, "bench");
+  std::stringstream image;
+  GCodeBytecodeWriter().write(*module, image);
+  std::string bytes = image.str();
+  GCodeBytecodeReader reader;
+  bench.setItems(ProgramLines);
+  bench.run([&]() {
+    auto loaded = reader.read(bytes.data(), bytes.size());
+    GCodeBench::doNotOptimize(loaded);
+  });
+}
\ No newline at end of file
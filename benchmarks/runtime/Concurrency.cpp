@@ -0,0 +1,61 @@
+#include "Fixtures.h"
+#include "gcodelib/Frontend.h"
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+static constexpr std::size_t ProgramLines = 1000;
+static constexpr std::size_t RunsPerThread = 4;
+
+static std::unique_ptr<GCodeIRModule> compile_shared() {
+  std::stringstream source;
+  for (std::size_t i = 0; i < ProgramLines; i++) {
+    source << "G1 X" << (i % 200) * 0.1 << " Y" << (i % 150) * 0.2
+      << " Z0.3 E" << i * 0.01 << " F1800" << std::endl;
+  }
+  GCodeRepRap compiler;
+  auto module = compiler.compile(source, "bench");
+  module->freeze();
+  return module;
+}
+
+static void run_shared(GCodeBench::Measurement &bench, std::size_t threads) {
+  threads = std::max<std::size_t>(1, std::min<std::size_t>(threads, std::thread::hardware_concurrency()));
+  auto module = compile_shared();
+  const GCodeIRModule &shared = *module;
+  bench.setItems(threads * RunsPerThread * ProgramLines);
+  bench.run([&]() {
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads; i++) {
+      workers.emplace_back([&shared]() {
+        GCodeBench::GCodeBenchInterpreter interp(shared);
+        for (std::size_t run = 0; run < RunsPerThread; run++) {
+          interp.execute();
+        }
+        GCodeBench::doNotOptimize(interp.getSyscallCount());
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  });
+}
+
+BENCHMARK_CASE("Concurrency/Shared module: 1 thread") {
+  run_shared(bench, 1);
+}
+
+BENCHMARK_CASE("Concurrency/Shared module: 2 threads") {
+  run_shared(bench, 2);
+}
+
+BENCHMARK_CASE("Concurrency/Shared module: 4 threads") {
+  run_shared(bench, 4);
+}
+
+BENCHMARK_CASE("Concurrency/Shared module: 8 threads") {
+  run_shared(bench, 8);
+}
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "Fixtures.h"
+#include "gcodelib/Frontend.h"
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+static constexpr std::size_t StreamLines = 2000;
+
+static std::unique_ptr<GCodeIRModule> compile_stream() {
+  std::stringstream source;
+  for (std::size_t i = 0; i < StreamLines; i++) {
+    source << "G1 X" << (i % 200) * 0.1 << " Y" << (i % 150) * 0.2
+      << " Z0.3 E" << i * 0.01 << " F1800" << std::endl;
+  }
+  GCodeRepRap compiler;
+  return compiler.compile(source, "bench");
+}
+
+class GCodeDictionaryInterpreter : public GCodeBench::GCodeBenchInterpreter {
+ public:
+  using GCodeBenchInterpreter::GCodeBenchInterpreter;
+ protected:
+  using GCodeBenchInterpreter::syscall;
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &args) override {
+    double x = args.get('X').asFloat();
+    double y = args.get('Y').asFloat();
+    double f = args.get('F').asFloat();
+    GCodeBench::doNotOptimize(x);
+    GCodeBench::doNotOptimize(y);
+    GCodeBench::doNotOptimize(f);
+  }
+
+  void syscall(GCodeSyscallType type, const GCodeRuntimeValue &function, const GCodeSyscallArguments &args) override {
+    GCodeInterpreter::syscall(type, function, args);
+  }
+};
+
+class GCodeRecordInterpreter : public GCodeBench::GCodeBenchInterpreter {
+ public:
+  using GCodeBenchInterpreter::GCodeBenchInterpreter;
+ protected:
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeSyscallArguments &args) override {
+    double x = args.get('X');
+    double y = args.get('Y');
+    double f = args.get('F');
+    GCodeBench::doNotOptimize(x);
+    GCodeBench::doNotOptimize(y);
+    GCodeBench::doNotOptimize(f);
+  }
+};
+
+static void run_program(GCodeBench::Measurement &bench, const std::string &program) {
+  std::stringstream source(program);
+  GCodeLinuxCNC compiler;
+  auto module = compiler.compile(source, "bench");
+  GCodeBench::GCodeBenchInterpreter interp(*module);
+  GCodeTelemetry telemetry(*module);
+  interp.setTelemetry(&telemetry);
+  interp.execute();
+  interp.setTelemetry(nullptr);
+  bench.setItems(telemetry.getInstructions());
+  bench.run([&]() {
+    interp.execute();
+  });
+}
+
+BENCHMARK_CASE("Interpreter/LinuxCNC arithmetic") {
+  run_program(bench,
+    "#<acc> = 1\n"
+    "o1 repeat [2000]\n"
+    "#<acc> = [[#<acc> * 3 + 7] MOD 1000 - 2 / 4 + [#<acc> GT 500]]\n"
+    "o1 endrepeat\n");
+}
+
+BENCHMARK_CASE("Interpreter/LinuxCNC loop") {
+  run_program(bench,
+    "#<idx> = 0\n"
+    "o1 while [#<idx> LT 5000]\n"
+    "#<idx> = [#<idx> + 1]\n"
+    "o1 endwhile\n");
+}
+
+BENCHMARK_CASE("Interpreter/LinuxCNC calls") {
+  run_program(bench,
+    "o100 sub\n"
+    "#<tmp> = [#0 * 2]\n"
+    "o100 endsub\n"
+    "#<idx> = 0\n"
+    "o1 repeat [2000]\n"
+    "o100 call [#<idx>]\n"
+    "#<idx> = [#<idx> + 1]\n"
+    "o1 endrepeat\n");
+}
+
+BENCHMARK_CASE("Interpreter/LinuxCNC syscalls") {
+  run_program(bench,
+    "#<idx> = 0\n"
+    "o1 repeat [2000]\n"
+    "G1 X#<idx> Y[#<idx> * 2] F1800\n"
+    "#<idx> = [#<idx> + 1]\n"
+    "o1 endrepeat\n");
+}
+
+BENCHMARK_CASE("Interpreter/RepRap stream: dictionary syscalls") {
+  auto module = compile_stream();
+  GCodeDictionaryInterpreter interp(*module);
+  bench.setItems(StreamLines);
+  bench.run([&]() {
+    interp.execute();
+  });
+}
+
+BENCHMARK_CASE("Interpreter/RepRap stream: record syscalls") {
+  auto module = compile_stream();
+  GCodeRecordInterpreter interp(*module);
+  bench.setItems(StreamLines);
+  bench.run([&]() {
+    interp.execute();
+  });
+}
+
+BENCHMARK_CASE("Interpreter/RepRap stream: batched records") {
+  auto module = compile_stream();
+  GCodeBench::GCodeBenchInterpreter interp(*module);
+  std::vector<GCodeCommandRecord> buffer(256);
+  bench.setItems(StreamLines);
+  bench.run([&]() {
+    interp.start();
+    while (!interp.isFinished()) {
+      double feed = 0.0;
+      for (const auto &cmd : interp.executeBatch(buffer.data(), buffer.size())) {
+        feed += cmd.get('F');
+      }
+      GCodeBench::doNotOptimize(feed);
+    }
+  });
+}
+
+BENCHMARK_CASE("Interpreter/RepRap stream: profiled") {
+  auto module = compile_stream();
+  GCodeRecordInterpreter interp(*module);
+  GCodeProfiler profiler(*module);
+  interp.setProfiler(&profiler);
+  bench.setItems(StreamLines);
+  bench.run([&]() {
+    interp.execute();
+  });
+}
+
+BENCHMARK_CASE("Interpreter/RepRap stream: virtual tracer") {
+  auto module = compile_stream();
+  GCodeRecordInterpreter interp(*module);
+  GCodeTracer tracer;
+  interp.setTracer(&tracer);
+  bench.setItems(StreamLines);
+  bench.run([&]() {
+    interp.execute();
+  });
+}
+
+BENCHMARK_CASE("Interpreter/RepRap stream: ring buffer tracer") {
+  auto module = compile_stream();
+  GCodeRecordInterpreter interp(*module);
+  GCodeRingBufferTracer tracer;
+  interp.setTracer(&tracer);
+  bench.setItems(StreamLines);
+  bench.run([&]() {
+    interp.execute();
+  });
+}
+
+BENCHMARK_CASE("Interpreter/RepRap stream: telemetry") {
+  auto module = compile_stream();
+  GCodeRecordInterpreter interp(*module);
+  GCodeTelemetry telemetry(*module);
+  interp.setTelemetry(&telemetry);
+  bench.setItems(StreamLines);
+  bench.run([&]() {
+    interp.execute();
+  });
+}
+
+BENCHMARK_CASE("Interpreter/RepRap stream: coverage") {
+  auto module = compile_stream();
+  GCodeRecordInterpreter interp(*module);
+  GCodeCoverage coverage(*module);
+  interp.setCoverage(&coverage);
+  bench.setItems(StreamLines);
+  bench.run([&]() {
+    interp.execute();
+  });
+}
+
+BENCHMARK_CASE("Interpreter/RepRap stream: polled telemetry") {
+  auto module = compile_stream();
+  GCodeRecordInterpreter interp(*module);
+  GCodeTelemetry telemetry(*module);
+  interp.setTelemetry(&telemetry);
+  std::atomic<bool> done = false;
+  std::thread reader([&]() {
+    while (!done.load()) {
+      GCodeBench::doNotOptimize(telemetry.read());
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  bench.setItems(StreamLines);
+  bench.run([&]() {
+    interp.execute();
+  });
+  done = true;
+  reader.join();
+}
\ No newline at end of file
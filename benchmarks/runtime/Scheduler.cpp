@@ -0,0 +1,50 @@
+#include "Fixtures.h"
+#include "gcodelib/Frontend.h"
+#include "gcodelib/runtime/Scheduler.h"
+#include <sstream>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+static constexpr std::size_t JobCount = 1000;
+static constexpr std::size_t JobLines = 100;
+
+static std::unique_ptr<GCodeIRModule> compile_job() {
+  std::stringstream source;
+  for (std::size_t i = 0; i < JobLines; i++) {
+    source << "G1 X" << (i % 200) * 0.1 << " Y" << (i % 150) * 0.2 << " F1800" << std::endl;
+  }
+  GCodeRepRap compiler;
+  auto module = compiler.compile(source, "bench");
+  module->freeze();
+  return module;
+}
+
+BENCHMARK_CASE("Scheduler/1000 jobs on worker pool") {
+  auto module = compile_job();
+  std::vector<std::unique_ptr<GCodeBench::GCodeBenchInterpreter>> interpreters;
+  for (std::size_t i = 0; i < JobCount; i++) {
+    interpreters.push_back(std::make_unique<GCodeBench::GCodeBenchInterpreter>(*module));
+  }
+  bench.setItems(JobCount * JobLines);
+  bench.run([&]() {
+    GCodeJobScheduler scheduler;
+    std::vector<GCodeScheduledJob *> jobs;
+    for (auto &interp : interpreters) {
+      jobs.push_back(&scheduler.submit(*interp));
+    }
+    std::size_t remaining = jobs.size();
+    while (remaining > 0) {
+      remaining = 0;
+      for (GCodeScheduledJob *job : jobs) {
+        GCodeCommandRecord record;
+        while (job->tryPop(record)) {
+          GCodeBench::doNotOptimize(record);
+        }
+        if (!job->isDone()) {
+          remaining++;
+        }
+      }
+    }
+  });
+}
\ No newline at end of file
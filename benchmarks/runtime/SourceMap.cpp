@@ -0,0 +1,45 @@
+#include "Fixtures.h"
+#include "gcodelib/Frontend.h"
+#include <sstream>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+static constexpr std::size_t ProgramLines = 20000;
+static constexpr std::size_t Lookups = 10000;
+
+static std::unique_ptr<GCodeIRModule> compile_program() {
+  std::stringstream source;
+  for (std::size_t i = 0; i < ProgramLines; i++) {
+    source << "G1 X" << (i % 200) * 0.1 << " Y" << (i % 150) * 0.2 << " F1800" << std::endl;
+  }
+  GCodeRepRap compiler;
+  return compiler.compile(source, "bench");
+}
+
+BENCHMARK_CASE("SourceMap/Locate address") {
+  auto module = compile_program();
+  const IRSourceMap &map = module->getSourceMap();
+  std::size_t stride = module->length() / Lookups + 1;
+  bench.setItems(Lookups);
+  bench.run([&]() {
+    uint32_t lines = 0;
+    for (std::size_t addr = 0; addr < module->length(); addr += stride) {
+      lines += map.locate(addr).value().getLine();
+    }
+    GCodeBench::doNotOptimize(lines);
+  });
+}
+
+BENCHMARK_CASE("SourceMap/Find line address") {
+  auto module = compile_program();
+  const IRSourceMap &map = module->getSourceMap();
+  bench.setItems(Lookups);
+  bench.run([&]() {
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < Lookups; i++) {
+      sum += map.findAddress(static_cast<uint32_t>(i % ProgramLines + 1)).value_or(0);
+    }
+    GCodeBench::doNotOptimize(sum);
+  });
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "Fixtures.h"
+#include "gcodelib/Frontend.h"
+#include <sstream>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+static constexpr int64_t WorkOffsets = 5221;
+static constexpr int64_t WorkOffsetStride = 20;
+static constexpr int64_t ProbeResults = 5061;
+static constexpr std::size_t MacroSteps = 1000;
+
+static void setup_parameters(GCodeVariableScope &scope) {
+  for (int64_t system = 0; system < 9; system++) {
+    for (int64_t axis = 0; axis < 9; axis++) {
+      scope.getNumbered().put(WorkOffsets + system * WorkOffsetStride + axis, static_cast<double>(axis));
+    }
+  }
+  for (int64_t param = 1; param <= 30; param++) {
+    scope.getNumbered().put(param, 0.0);
+  }
+}
+
+static void run_macro(GCodeVariableScope &scope) {
+  GCodeDictionary<int64_t> &numbered = scope.getNumbered();
+  for (std::size_t step = 0; step < MacroSteps; step++) {
+    int64_t offset = WorkOffsets + static_cast<int64_t>(step % 9) * WorkOffsetStride;
+    double x = numbered.get(offset).asFloat() + numbered.get(1).asFloat();
+    double y = numbered.get(offset + 1).asFloat() + numbered.get(2).asFloat();
+    numbered.put(ProbeResults, x);
+    numbered.put(ProbeResults + 1, y);
+    numbered.put(1, x * 0.5);
+    numbered.put(2, y * 0.5);
+  }
+}
+
+template <typename Scope>
+static void bench_scope(GCodeBench::Measurement &bench) {
+  GCodeScopedDictionary<int64_t> numbered;
+  GCodeScopedDictionary<std::string> named;
+  GCodeCustomVariableScope system(numbered, named);
+  Scope scope(&system);
+  setup_parameters(scope);
+  bench.setItems(MacroSteps * 8);
+  bench.run([&]() {
+    run_macro(scope);
+  });
+}
+
+BENCHMARK_CASE("Storage/numbered parameters: map scope") {
+  bench_scope<GCodeCascadeVariableScope>(bench);
+}
+
+BENCHMARK_CASE("Storage/numbered parameters: dense scope") {
+  bench_scope<GCodeDenseVariableScope>(bench);
+}
+
+BENCHMARK_CASE("Storage/numbered parameter macro") {
+  std::stringstream source;
+  source << "#5221 = 1.5" << std::endl
+    << "#5222 = 2.5" << std::endl
+    << "#1 = 0" << std::endl
+    << "o100 while [#1 LT " << MacroSteps << "]" << std::endl
+    << "  #5061 = [#5221 + #1]" << std::endl
+    << "  #5062 = [#5222 * #5061]" << std::endl
+    << "  #5063 = [#5061 + #5062]" << std::endl
+    << "  #1 = [#1 + 1]" << std::endl
+    << "o100 endwhile" << std::endl;
+  GCodeLinuxCNC compiler;
+  auto module = compiler.compile(source, "bench");
+  GCodeBench::GCodeBenchInterpreter interp(*module);
+  bench.setItems(MacroSteps * 9);
+  bench.run([&]() {
+    interp.execute();
+  });
+}
+
+BENCHMARK_CASE("Storage/fork paused interpreter") {
+  std::stringstream source;
+  for (int64_t param = 1; param <= 5000; param += 3) {
+    source << "#" << param << " = " << param << std::endl;
+  }
+  source << "#<feed> = 1.0" << std::endl
+    << "#1 = 0" << std::endl
+    << "o100 while [#1 LT 100]" << std::endl
+    << "  G1 X[#1 * #<feed>] Y#100" << std::endl
+    << "  #1 = [#1 + 1]" << std::endl
+    << "o100 endwhile" << std::endl;
+  GCodeLinuxCNC compiler;
+  auto module = compiler.compile(source, "bench");
+  GCodeBench::GCodeBenchInterpreter interp(*module);
+  interp.start();
+  interp.runUntilSyscall();
+  GCodeBench::GCodeBenchInterpreter branch(*module);
+  bench.setItems(1);
+  bench.run([&]() {
+    interp.fork(branch);
+    branch.runUntilSyscall();
+  });
+}
\ No newline at end of file
@@ -1,8 +1,23 @@
+option(GCODELIB_ALLOCATION_ACCOUNTING "Replace global operator new/delete to feed GCodeAllocationCounter" OFF)
+
 file(GLOB_RECURSE GCODELIB_SRC ${CMAKE_CURRENT_LIST_DIR}/../source/*.cpp)
+list(FILTER GCODELIB_SRC EXCLUDE REGEX ".*/source/Allocation\\.cpp$")
 set(GCODELIB_HEADERS ${CMAKE_CURRENT_LIST_DIR}/../headers)
 add_library(GCodeLib STATIC ${GCODELIB_SRC})
 target_include_directories(GCodeLib PUBLIC ${GCODELIB_HEADERS})
 set_property(TARGET GCodeLib PROPERTY CXX_STANDARD 17)
 set_property(TARGET GCodeLib PROPERTY CXX_EXTENSIONS OFF)
 set_property(TARGET GCodeLib PROPERTY POSITION_INDEPENDENT_CODE ON)
+
+# Replacement operator new/delete, opt-in. The objects are linked straight into consumers so that
+# the definitions are used even though nothing references them by name.
+add_library(GCodeLibAllocationHooks OBJECT ${CMAKE_CURRENT_LIST_DIR}/../source/Allocation.cpp)
+target_include_directories(GCodeLibAllocationHooks PUBLIC ${GCODELIB_HEADERS})
+set_property(TARGET GCodeLibAllocationHooks PROPERTY CXX_STANDARD 17)
+set_property(TARGET GCodeLibAllocationHooks PROPERTY CXX_EXTENSIONS OFF)
+set_property(TARGET GCodeLibAllocationHooks PROPERTY POSITION_INDEPENDENT_CODE ON)
+if(GCODELIB_ALLOCATION_ACCOUNTING)
+  target_sources(GCodeLib INTERFACE $<TARGET_OBJECTS:GCodeLibAllocationHooks>)
+endif()
+
 set(GCODELIB_LIBS GCodeLib)
\ No newline at end of file
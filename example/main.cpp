@@ -30,6 +30,16 @@ class EchoInterpreter : public GCodeInterpreter {
   }
 
  protected:
+  void syscall(GCodeSyscallType type, const GCodeRuntimeValue &function, const GCodeSyscallArguments &args) override {
+    std::cout << static_cast<unsigned char>(type) << function << '\t';
+    for (unsigned char key = 'A'; key <= 'Z'; key++) {
+      if (args.has(key)) {
+        std::cout << key << args.getValue(key) << ' ';
+      }
+    }
+    std::cout << std::endl;
+  }
+
   void syscall(GCodeSyscallType type, const GCodeRuntimeValue &function, const GCodeScopedDictionary<unsigned char> &args) override {
     std::cout << static_cast<unsigned char>(type) << function << '\t';
     for (auto kv : args) {
@@ -51,6 +61,9 @@ static constexpr auto CommandRepRap = "reprap";
 static constexpr auto CommandLinuxCNC = "linuxcnc";
 static constexpr auto CommandAST = "print-ast";
 static constexpr auto CommandBytecode = "print-bytecode";
+static constexpr auto CommandStatistics = "print-stats";
+static constexpr auto CommandTimeline = "trace-timeline";
+static constexpr auto CommandCoverage = "write-coverage";
 
 int main(int argc, const char **argv) {
   if (argc < 2) {
@@ -73,7 +86,30 @@ int main(int argc, const char **argv) {
   }
   try {
     std::ifstream is(argv[1]);
-    if (mode.compare(CommandAST) != 0) {
+    if (mode.compare(CommandStatistics) == 0) {
+      GCodeCompilerStatistics stats;
+      compiler->compile(is, fileName, stats);
+      std::cout << stats << std::endl;
+    } else if (mode.compare(CommandTimeline) == 0) {
+      std::ofstream trace(argc > 4 ? argv[4] : "timeline.json");
+      GCodeChromeTraceWriter writer(trace);
+      compiler->setTimeline(&writer);
+      auto ir = compiler->compile(is, fileName);
+      is.close();
+      EchoInterpreter interp(*ir);
+      GCodeTimelineTracer timeline(*ir, writer);
+      interp.setTimeline(&timeline);
+      interp.execute();
+    } else if (mode.compare(CommandCoverage) == 0) {
+      auto ir = compiler->compile(is, fileName);
+      is.close();
+      EchoInterpreter interp(*ir);
+      GCodeCoverage coverage(*ir);
+      interp.setCoverage(&coverage);
+      interp.execute();
+      std::ofstream lcov(argc > 4 ? argv[4] : "coverage.info");
+      coverage.writeLcov(lcov);
+    } else if (mode.compare(CommandAST) != 0) {
       auto ir = compiler->compile(is, fileName);
       is.close();
       if (mode.compare(CommandBytecode) == 0) {
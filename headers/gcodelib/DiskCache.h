@@ -0,0 +1,54 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_DISKCACHE_H_
+#define GCODELIB_DISKCACHE_H_
+
+#include "gcodelib/Frontend.h"
+#include <vector>
+
+namespace GCodeLib {
+
+  struct GCodeDiskCacheStatistics {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t invalidations = 0;
+    std::size_t writes = 0;
+  };
+
+  class GCodeDiskCache {
+   public:
+    GCodeDiskCache(const std::string &);
+
+    std::unique_ptr<Runtime::GCodeIRModule> compile(GCodeCompilerFrontend &, std::istream &, const std::string & = "", const std::vector<std::string> & = {});
+    std::unique_ptr<Runtime::GCodeIRModule> compileFile(GCodeCompilerFrontend &, const std::string &, const std::vector<std::string> & = {});
+    const std::string &getDirectory() const;
+    const GCodeDiskCacheStatistics &getStatistics() const;
+
+    static constexpr uint32_t Version = 2;
+   private:
+    struct Dependency {
+      std::string path;
+      std::string content;
+    };
+
+    std::string getEntryPath(const std::string &, const std::string &, const std::string &) const;
+    std::unique_ptr<Runtime::GCodeIRModule> lookup(const std::string &, const std::string &, const std::string &, const std::string &);
+    void store(const std::string &, const std::string &, const std::string &, const std::string &, const std::vector<Dependency> &, const Runtime::GCodeIRModule &);
+
+    std::string directory;
+    GCodeDiskCacheStatistics statistics;
+  };
+}
+
+#endif
\ No newline at end of file
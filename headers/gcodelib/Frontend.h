@@ -15,9 +15,13 @@
 #define GCODELIB_FRONTEND_H_
 
 #include "gcodelib/Base.h"
+#include "gcodelib/Statistics.h"
+#include "gcodelib/Timeline.h"
 #include "gcodelib/runtime/Translator.h"
 #include "gcodelib/parser/linuxcnc/LinuxCNC.h"
 #include "gcodelib/parser/reprap/RepRap.h"
+#include <algorithm>
+#include <chrono>
 #include <type_traits>
 #include <iosfwd>
 
@@ -25,6 +29,52 @@ namespace GCodeLib {
 
   namespace Internal {
     struct EmptyValidator {};
+
+    // Reading the clock around every token costs about as much as scanning a short one, so only every
+    // SampleInterval-th call is timed and the scan time is extrapolated from those samples
+    template <typename Token>
+    class CountingScanner : public Parser::GCodeScanner<Token> {
+     public:
+      CountingScanner(Parser::GCodeScanner<Token> &scanner, GCodeCompilerStatistics &statistics)
+        : scanner(scanner), statistics(statistics), calls(0), samples(0), sampled(0) {}
+
+      std::optional<Token> next() override {
+        auto memory = GCodeAllocationCounter::getThreadTotals();
+        std::optional<Token> token;
+        if (this->calls++ % SampleInterval == 0) {
+          auto start = std::chrono::steady_clock::now();
+          token = this->scanner.next();
+          this->sampled += std::chrono::steady_clock::now() - start;
+          this->samples++;
+        } else {
+          token = this->scanner.next();
+        }
+        this->statistics.scanMemory += GCodeAllocationCounter::getThreadTotals() - memory;
+        if (token.has_value()) {
+          this->statistics.tokens++;
+        }
+        return token;
+      }
+
+      bool finished() override {
+        return this->scanner.finished();
+      }
+
+      std::chrono::nanoseconds getScanTime() const {
+        using Rep = std::chrono::nanoseconds::rep;
+        return this->samples > 0
+          ? std::chrono::duration_cast<std::chrono::nanoseconds>(this->sampled) * static_cast<Rep>(this->calls) / static_cast<Rep>(this->samples)
+          : std::chrono::nanoseconds(0);
+      }
+
+      static constexpr std::size_t SampleInterval = 16;
+     private:
+      Parser::GCodeScanner<Token> &scanner;
+      GCodeCompilerStatistics &statistics;
+      std::size_t calls;
+      std::size_t samples;
+      std::chrono::steady_clock::duration sampled;
+    };
   }
 
   class GCodeCompilerFrontend {
@@ -32,6 +82,27 @@ namespace GCodeLib {
     virtual ~GCodeCompilerFrontend() = default;
     virtual std::unique_ptr<Parser::GCodeBlock> parse(std::istream &, const std::string & = "") = 0;
     virtual std::unique_ptr<Runtime::GCodeIRModule> compile(std::istream &, const std::string & = "") = 0;
+
+    // Frontends without phase instrumentation compile normally and report zeroed statistics
+    virtual std::unique_ptr<Runtime::GCodeIRModule> compile(std::istream &is, const std::string &tag, GCodeCompilerStatistics &statistics) {
+      statistics = GCodeCompilerStatistics{};
+      return this->compile(is, tag);
+    }
+
+    void setTimeline(GCodeTimelineSink *timeline) {
+      this->timeline = timeline;
+    }
+
+    GCodeTimelineSink *getTimeline() const {
+      return this->timeline;
+    }
+   protected:
+    void span(std::string name, GCodeTimelineSpan::Clock::time_point begin, GCodeTimelineSpan::Clock::duration duration,
+      std::vector<std::pair<const char *, uint64_t>> args = {}) {
+      this->timeline->record(GCodeTimelineSpan { std::move(name), "compile", begin, duration, GCodeTimelineSink::currentThread(), std::move(args) });
+    }
+
+    GCodeTimelineSink *timeline = nullptr;
   };
 
   template <class Scanner, class Parser, class Mangler, class Validator = Internal::EmptyValidator>
@@ -56,6 +127,10 @@ namespace GCodeLib {
     }
 
     std::unique_ptr<Runtime::GCodeIRModule> compile(std::istream &is, const std::string &tag) override {
+      if (this->timeline != nullptr) {
+        GCodeCompilerStatistics statistics;
+        return this->compile(is, tag, statistics);
+      }
       Scanner scanner(is, tag);
       Parser parser(scanner, this->mangler);
       auto ast = parser.parse();
@@ -64,6 +139,54 @@ namespace GCodeLib {
       }
       return this->translator.translate(*ast);
     }
+
+    std::unique_ptr<Runtime::GCodeIRModule> compile(std::istream &is, const std::string &tag, GCodeCompilerStatistics &statistics) override {
+      using Clock = std::chrono::steady_clock;
+      statistics = GCodeCompilerStatistics{};
+      GCodeAllocationCounter allocations;
+      auto compileStart = Clock::now();
+      Scanner scanner(is, tag);
+      Internal::CountingScanner<typename Scanner::TokenType> countingScanner(scanner, statistics);
+      auto memory = GCodeAllocationCounter::getThreadTotals();
+      auto parseStart = Clock::now();
+      Parser parser(countingScanner, this->mangler);
+      auto ast = parser.parse();
+      auto parseTime = Clock::now() - parseStart;
+      statistics.scan = std::min(countingScanner.getScanTime(), std::chrono::duration_cast<std::chrono::nanoseconds>(parseTime));
+      statistics.parse = parseTime - statistics.scan;
+      statistics.parseMemory = GCodeAllocationCounter::getThreadTotals() - memory - statistics.scanMemory;
+      statistics.nodes = GCodeCompilerStatistics::countNodes(*ast);
+      auto validateStart = Clock::now();
+      if constexpr (!std::is_same<Validator, Internal::EmptyValidator>()) {
+        memory = GCodeAllocationCounter::getThreadTotals();
+        validateStart = Clock::now();
+        this->validator.validate(*ast);
+        statistics.validate = Clock::now() - validateStart;
+        statistics.validateMemory = GCodeAllocationCounter::getThreadTotals() - memory;
+      }
+      memory = GCodeAllocationCounter::getThreadTotals();
+      auto translateStart = Clock::now();
+      auto module = this->translator.translate(*ast);
+      statistics.translate = Clock::now() - translateStart;
+      statistics.translateMemory = GCodeAllocationCounter::getThreadTotals() - memory;
+      statistics.instructions = module->length();
+      statistics.sourceMapBlocks = module->getSourceMap().size();
+      statistics.sourceMapBytes = module->getSourceMap().getFootprint();
+      statistics.moduleBytes = module->getFootprint() - statistics.sourceMapBytes;
+      statistics.allocations = allocations.getAllocations();
+      statistics.peakBytes = allocations.getPeakBytes();
+      if (this->timeline != nullptr) {
+        this->span(tag.empty() ? "compile" : "compile " + tag, compileStart, Clock::now() - compileStart);
+        this->span("parse", parseStart, parseTime, {{"nodes", statistics.nodes}});
+        // Scanning is interleaved with parsing, so its time is folded into one span at the start of the parse
+        this->span("scan", parseStart, statistics.scan, {{"tokens", statistics.tokens}});
+        if constexpr (!std::is_same<Validator, Internal::EmptyValidator>()) {
+          this->span("validate", validateStart, statistics.validate);
+        }
+        this->span("translate", translateStart, statistics.translate, {{"instructions", statistics.instructions}});
+      }
+      return module;
+    }
    private:
     Mangler mangler;
     Validator validator;
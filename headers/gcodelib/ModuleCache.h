@@ -0,0 +1,87 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_MODULECACHE_H_
+#define GCODELIB_MODULECACHE_H_
+
+#include "gcodelib/Frontend.h"
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace GCodeLib {
+
+  struct GCodeModuleKey {
+    uint64_t hash;
+    std::size_t length;
+    std::string dialect;
+    std::string tag;
+
+    bool operator<(const GCodeModuleKey &) const;
+  };
+
+  struct GCodeModuleCacheStatistics {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t footprint = 0;
+  };
+
+  // Modules are keyed by source hash, length, dialect and tag; a hit is only returned after
+  // comparing the full source. Misses compile on the caller's frontend. The cache serializes its
+  // own compiles on a shared frontend, but callers must not use that frontend concurrently elsewhere.
+  class GCodeModuleCache {
+   public:
+    using ModulePtr = std::shared_ptr<const Runtime::GCodeIRModule>;
+
+    GCodeModuleCache(std::size_t = DefaultCapacity, std::size_t = 0);
+    GCodeModuleCache(const GCodeModuleCache &) = delete;
+    GCodeModuleCache &operator=(const GCodeModuleCache &) = delete;
+
+    ModulePtr compile(GCodeCompilerFrontend &, std::istream &, const std::string & = "");
+    ModulePtr compile(GCodeCompilerFrontend &, const std::string &, const std::string & = "");
+    void clear();
+    GCodeModuleCacheStatistics getStatistics() const;
+
+    static uint64_t hash(const std::string &);
+    static constexpr std::size_t DefaultCapacity = 64;
+   private:
+    struct Entry {
+      std::string source;
+      std::shared_future<ModulePtr> module;
+      std::list<GCodeModuleKey>::iterator position;
+      std::size_t footprint;
+      bool ready;
+    };
+
+    struct FrontendLock {
+      std::mutex mutex;
+      std::size_t users = 0;
+    };
+
+    void evict();
+    ModulePtr translate(GCodeCompilerFrontend &, const std::string &, const std::string &);
+
+    std::size_t capacity;
+    std::size_t memoryLimit;
+    mutable std::mutex mutex;
+    std::map<GCodeModuleKey, Entry> entries;
+    std::list<GCodeModuleKey> recent;
+    std::map<const GCodeCompilerFrontend *, FrontendLock> frontends;
+    GCodeModuleCacheStatistics statistics;
+  };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_STATISTICS_H_
+#define GCODELIB_STATISTICS_H_
+
+#include "gcodelib/Base.h"
+#include "gcodelib/parser/AST.h"
+#include <chrono>
+#include <iosfwd>
+
+namespace GCodeLib {
+
+  struct GCodeAllocationStatistics {
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+
+    GCodeAllocationStatistics operator-(const GCodeAllocationStatistics &) const;
+    GCodeAllocationStatistics &operator+=(const GCodeAllocationStatistics &);
+  };
+
+  class GCodeAllocationCounter {
+   public:
+    GCodeAllocationCounter();
+    GCodeAllocationCounter(const GCodeAllocationCounter &) = delete;
+    GCodeAllocationCounter &operator=(const GCodeAllocationCounter &) = delete;
+    ~GCodeAllocationCounter();
+
+    std::size_t getAllocations() const;
+    std::size_t getAllocatedBytes() const;
+    std::size_t getPeakBytes() const;
+
+    // Forwarded by the host's operator new/delete, or by the gcodelib_allocation_hooks replacements
+    static void allocate(std::size_t);
+    static void deallocate(std::size_t);
+    static GCodeAllocationStatistics getThreadTotals();
+    static bool isInstrumented();
+   private:
+    GCodeAllocationCounter *previous;
+    std::size_t allocations;
+    std::size_t allocated;
+    int64_t current;
+    int64_t peak;
+  };
+
+  struct GCodeCompilerStatistics {
+    std::chrono::nanoseconds scan{0};
+    std::chrono::nanoseconds parse{0};
+    std::chrono::nanoseconds validate{0};
+    std::chrono::nanoseconds translate{0};
+    std::size_t tokens = 0;
+    std::size_t nodes = 0;
+    std::size_t instructions = 0;
+    std::size_t moduleBytes = 0;
+    std::size_t sourceMapBlocks = 0;
+    std::size_t sourceMapBytes = 0;
+    GCodeAllocationStatistics scanMemory;
+    GCodeAllocationStatistics parseMemory;
+    GCodeAllocationStatistics validateMemory;
+    GCodeAllocationStatistics translateMemory;
+    std::size_t allocations = 0;
+    std::size_t peakBytes = 0;
+
+    std::chrono::nanoseconds getTotalTime() const;
+    friend std::ostream &operator<<(std::ostream &, const GCodeCompilerStatistics &);
+
+    static std::size_t countNodes(const Parser::GCodeNode &);
+  };
+}
+
+#endif
\ No newline at end of file
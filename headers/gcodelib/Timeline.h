@@ -0,0 +1,66 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+#ifndef GCODELIB_TIMELINE_H_
+#define GCODELIB_TIMELINE_H_
+
+#include "gcodelib/Base.h"
+#include <chrono>
+#include <iosfwd>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace GCodeLib {
+
+  struct GCodeTimelineSpan {
+    using Clock = std::chrono::steady_clock;
+
+    std::string name;
+    const char *category;
+    Clock::time_point begin;
+    Clock::duration duration;
+    uint64_t thread;
+    std::vector<std::pair<const char *, uint64_t>> args;
+  };
+
+  // Receiver of compile and execution spans. Producers hold a nullable pointer, so tracing is off unless a sink is attached
+  class GCodeTimelineSink {
+   public:
+    virtual ~GCodeTimelineSink() = default;
+    virtual void record(const GCodeTimelineSpan &) = 0;
+
+    // Small sequential identifier of the calling thread
+    static uint64_t currentThread();
+  };
+
+  // Writes spans as Chrome trace-event JSON, loadable in chrome://tracing and Perfetto
+  class GCodeChromeTraceWriter : public GCodeTimelineSink {
+   public:
+    GCodeChromeTraceWriter(std::ostream &, uint64_t = 1);
+    ~GCodeChromeTraceWriter();
+    GCodeChromeTraceWriter(const GCodeChromeTraceWriter &) = delete;
+    GCodeChromeTraceWriter &operator=(const GCodeChromeTraceWriter &) = delete;
+    void record(const GCodeTimelineSpan &) override;
+    std::size_t getSpans() const;
+    void close();
+   private:
+    std::ostream &os;
+    uint64_t process;
+    GCodeTimelineSpan::Clock::time_point origin;
+    std::size_t spans;
+    bool closed;
+    mutable std::mutex mutex;
+  };
+}
+
+#endif
\ No newline at end of file
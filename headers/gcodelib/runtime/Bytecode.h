@@ -0,0 +1,52 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_RUNTIME_BYTECODE_H_
+#define GCODELIB_RUNTIME_BYTECODE_H_
+
+#include "gcodelib/runtime/IR.h"
+#include <iosfwd>
+
+namespace GCodeLib::Runtime {
+
+  enum class GCodeBytecodeSection : uint32_t {
+    Strings = 1,
+    Code = 2,
+    Symbols = 3,
+    Labels = 4,
+    Procedures = 5,
+    SourceMap = 6
+  };
+
+  class GCodeBytecodeWriter {
+   public:
+    void write(const GCodeIRModule &, std::ostream &);
+    void write(const GCodeIRModule &, const std::string &);
+  };
+
+  // Images are read into memory and fully deserialized into a new module; nothing is mapped or executed
+  // in place, so loading cost is linear in module size. load() reads the image from the given file offset
+  class GCodeBytecodeReader {
+   public:
+    std::unique_ptr<GCodeIRModule> read(const char *, std::size_t);
+    std::unique_ptr<GCodeIRModule> load(const std::string &, std::size_t = 0);
+  };
+
+  struct GCodeBytecodeFormat {
+    static constexpr char Magic[4] = { 'G', 'C', 'I', 'R' };
+    static constexpr uint16_t Version = 1;
+    static constexpr uint16_t ByteOrder = 0x0102;
+  };
+}
+
+#endif
\ No newline at end of file
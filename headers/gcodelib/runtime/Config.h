@@ -19,7 +19,8 @@ namespace GCodeLib::Runtime {
   class GCodeRuntimeConfig {
    public:
     constexpr GCodeRuntimeConfig()
-      : comparison_tolerance(GCodeRuntimeConfig::DefaultComparisonTolerance) {}
+      : comparison_tolerance(GCodeRuntimeConfig::DefaultComparisonTolerance),
+        call_stack_depth(GCodeRuntimeConfig::DefaultCallStackDepth) {}
 
     constexpr double getComparisonTolerance() const {
       return this->comparison_tolerance;
@@ -37,10 +38,25 @@ namespace GCodeLib::Runtime {
         return true;
       }
     }
+
+    constexpr std::size_t getCallStackDepth() const {
+      return this->call_stack_depth;
+    }
+
+    constexpr bool setCallStackDepth(std::size_t depth) {
+      if (depth == 0) {
+        return false;
+      } else {
+        this->call_stack_depth = depth;
+        return true;
+      }
+    }
     
     static constexpr double DefaultComparisonTolerance = 0.0001;
+    static constexpr std::size_t DefaultCallStackDepth = 64;
     static const GCodeRuntimeConfig Default;
    private:
     double comparison_tolerance;
+    std::size_t call_stack_depth;
   };
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+#ifndef GCODELIB_RUNTIME_COVERAGE_H_
+#define GCODELIB_RUNTIME_COVERAGE_H_
+
+#include "gcodelib/runtime/Trace.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace GCodeLib::Runtime {
+
+  // One bit per IR address. Bitmaps of the same module merge with a word-wise OR
+  class GCodeCoverageBitmap {
+   public:
+    GCodeCoverageBitmap(std::size_t = 0);
+    std::size_t size() const;
+    bool test(std::size_t) const;
+    std::size_t count() const;
+    void clear();
+    void write(std::ostream &) const;
+    static GCodeCoverageBitmap read(std::istream &, std::size_t = AnySize);
+
+    void set(std::size_t address) {
+      this->words[address >> 6] |= uint64_t{1} << (address & 63);
+    }
+
+    GCodeCoverageBitmap &operator|=(const GCodeCoverageBitmap &);
+    bool operator==(const GCodeCoverageBitmap &) const;
+    bool operator!=(const GCodeCoverageBitmap &) const;
+
+    static constexpr char Magic[4] = { 'G', 'C', 'C', 'V' };
+    static constexpr uint16_t Version = 1;
+    static constexpr std::size_t AnySize = SIZE_MAX;
+   private:
+    std::size_t bits;
+    std::vector<uint64_t> words;
+  };
+
+  struct GCodeCoverageLine {
+    std::string tag;
+    uint32_t line;
+    std::size_t instructions;
+    std::size_t covered;
+  };
+
+  class GCodeCoverage : private GCodeNullTracer {
+   public:
+    GCodeCoverage(const GCodeIRModule &);
+    const GCodeIRModule &getModule() const;
+    const GCodeCoverageBitmap &getBitmap() const;
+    void merge(const GCodeCoverageBitmap &);
+    void reset();
+    std::vector<GCodeCoverageLine> getLines() const;
+    void writeLcov(std::ostream &) const;
+
+    static std::vector<GCodeCoverageLine> getLines(const GCodeIRModule &, const GCodeCoverageBitmap &);
+    static void writeLcov(std::ostream &, const GCodeIRModule &, const GCodeCoverageBitmap &);
+
+    friend class GCodeInterpreter;
+   private:
+    void instruction(std::size_t address, const GCodeIRInstruction &) {
+      this->bitmap.set(address);
+    }
+
+    const GCodeIRModule &module;
+    GCodeCoverageBitmap bitmap;
+  };
+}
+
+#endif
\ No newline at end of file
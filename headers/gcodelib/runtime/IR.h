@@ -94,6 +94,8 @@ namespace GCodeLib::Runtime {
     void jump();
     void jumpIf();
     std::size_t getAddress() const;
+
+    friend class GCodeBytecodeReader;
    private:
     GCodeIRModule &module;
     std::optional<std::size_t> address;
@@ -108,20 +110,29 @@ namespace GCodeLib::Runtime {
     const GCodeIRInstruction &at(std::size_t) const;
 
     std::unique_ptr<GCodeIRPosition> newPositionRegister(const Parser::SourcePosition &);
-    IRSourceMap &getSourceMap();
+    const IRSourceMap &getSourceMap() const;
 
     std::size_t getSymbolId(const std::string &);
     const std::string &getSymbol(std::size_t) const;
     std::unique_ptr<GCodeIRLabel> newLabel();
     GCodeIRLabel &getNamedLabel(const std::string &);
     void registerProcedure(int64_t, const std::string &);
-    GCodeIRLabel &getProcedure(int64_t) const;
+    const GCodeIRLabel &getProcedure(int64_t) const;
     void appendInstruction(GCodeIROpcode, const GCodeRuntimeValue & = GCodeRuntimeValue::Empty);
     bool linked() const;
+    void freeze();
+    bool isFrozen() const;
+    std::size_t getFootprint() const;
 
     friend std::ostream &operator<<(std::ostream &, const GCodeIRModule &);
     friend class GCodeIRLabel;
+    friend class GCodeIRPosition;
+    friend class GCodeBytecodeWriter;
+    friend class GCodeBytecodeReader;
    private:
+    void assertMutable() const;
+
+    bool frozen = false;
     std::vector<GCodeIRInstruction> code;
     std::map<std::size_t, std::string> symbols;
     std::map<std::string, std::size_t> symbolIdentifiers;
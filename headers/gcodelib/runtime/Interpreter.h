@@ -16,29 +16,135 @@
 
 #include "gcodelib/runtime/IR.h"
 #include "gcodelib/runtime/Runtime.h"
+#include "gcodelib/runtime/Syscall.h"
+#include "gcodelib/runtime/Error.h"
+#include "gcodelib/runtime/Coverage.h"
+#include "gcodelib/runtime/Profiler.h"
+#include "gcodelib/runtime/Telemetry.h"
+#include "gcodelib/runtime/Timeline.h"
+#include "gcodelib/runtime/Trace.h"
 #include <stack>
 #include <map>
+#include <exception>
+#include <tuple>
 
 namespace GCodeLib::Runtime {
 
+  enum class GCodeExecutionStatus {
+    Yielded,
+    Finished,
+    Error
+  };
+
+  // Whether the host may be writing the system scope while a batch runs. Unsynchronized batches
+  // stop before every variable access instead of probing the system scope
+  enum class GCodeSystemScopeAccess {
+    Synchronized,
+    Unsynchronized
+  };
+
+  struct GCodeFastForwardSummary {
+    bool reached = false;
+    std::size_t address = 0;
+    std::size_t instructions = 0;
+    std::size_t syscalls = 0;
+    GCodeSyscallArguments modal;
+    std::map<GCodeSyscallType, double> functions;
+  };
+
   class GCodeInterpreter {
    public:
-    GCodeInterpreter(GCodeIRModule &);
+    GCodeInterpreter(const GCodeIRModule &);
     virtual ~GCodeInterpreter() = default;
     virtual void execute();
+    void start();
+    GCodeExecutionStatus runFor(std::size_t);
+    GCodeExecutionStatus runUntilSyscall(std::size_t = Unbounded);
+    GCodeCommandSpan executeBatch(GCodeCommandRecord *, std::size_t, std::size_t = Unbounded, GCodeSystemScopeAccess = GCodeSystemScopeAccess::Synchronized);
+    GCodeFastForwardSummary fastForward(uint32_t, const std::string & = "");
+    GCodeFastForwardSummary fastForward(const std::string &, uint32_t, const std::string & = "");
+    GCodeRuntimeSnapshot snapshot() const;
+    void restore(const GCodeRuntimeSnapshot &);
+    std::vector<GCodeRuntimeSnapshot> checkpoint(std::size_t);
+    void fork(GCodeInterpreter &) const;
+    void setProfiler(GCodeProfiler *);
+    GCodeProfiler *getProfiler() const;
+    void setTelemetry(GCodeTelemetry *);
+    GCodeTelemetry *getTelemetry() const;
+    void setTimeline(GCodeTimelineTracer *);
+    GCodeTimelineTracer *getTimeline() const;
+    void setCoverage(GCodeCoverage *);
+    GCodeCoverage *getCoverage() const;
+    void setTracer(std::nullptr_t);
+    void setTracer(GCodeTracer *);
+    void setTracer(GCodeRingBufferTracer *);
+    void setTracer(GCodeFileTracer *);
+    bool isFinished() const;
+    bool isWaitingForSystemScope() const;
+    const std::optional<GCodeRuntimeError> &getError() const;
+
+    static constexpr std::size_t Unbounded = SIZE_MAX;
    protected:
     GCodeFunctionScope &getFunctions();
     GCodeRuntimeState &getState();
     void interpret();
     void stop();
 
+    // Commands arrive through the record overload. Its default copies the record into a dictionary
+    // and forwards it to the dictionary overload, which every interpreter has to implement
+    virtual void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeSyscallArguments &);
     virtual void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &) = 0;
     virtual GCodeVariableScope &getSystemScope() = 0;
     
-    GCodeIRModule &module;
+    const GCodeIRModule &module;
     std::optional<GCodeRuntimeState> state;
     GCodeFunctionScope functions;
     GCodeRuntimeConfig config;
+   private:
+    // Each tracer kind has its own slot. A single attached tracer runs as the loop's policy directly,
+    // several attached tracers run through CompositeTracer, which forwards every hook to each of them.
+    using TracerSet = std::tuple<GCodeProfiler *, GCodeTelemetry *, GCodeTimelineTracer *, GCodeCoverage *, GCodeRingBufferTracer *, GCodeFileTracer *, GCodeTracer *>;
+    class CompositeTracer;
+
+    void run();
+    template <typename Tracer>
+    void trace(Tracer &);
+    template <typename Tracer>
+    void loop(Tracer &);
+
+    template <typename Tracer>
+    void attach(Tracer *tracer) {
+      std::get<Tracer *>(this->tracers) = tracer;
+    }
+
+    template <typename Tracer>
+    void attachEvents(Tracer *tracer) {
+      std::get<GCodeRingBufferTracer *>(this->tracers) = nullptr;
+      std::get<GCodeFileTracer *>(this->tracers) = nullptr;
+      std::get<GCodeTracer *>(this->tracers) = nullptr;
+      this->attach(tracer);
+    }
+
+    GCodeExecutionStatus resume(std::size_t, bool);
+    bool readsSystemScope(const GCodeIRInstruction &);
+    GCodeFastForwardSummary seek(std::size_t, const std::string &);
+    void skipSyscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeSyscallArguments &);
+
+    GCodeScopedDictionary<unsigned char> dictionaryArgs;
+    std::vector<GCodeRuntimeValue> invokeArgs;
+    GCodeCommandRecord *batch;
+    std::size_t batchCapacity;
+    std::size_t batchLength;
+    std::exception_ptr batchError;
+    GCodeSystemScopeAccess scopeAccess;
+    bool scopeStall;
+    std::optional<GCodeRuntimeError> error;
+    std::size_t budget;
+    bool yieldOnSyscall;
+    std::size_t stopAddress;
+    uint32_t trackedArguments;
+    GCodeFastForwardSummary *skipped;
+    TracerSet tracers;
   };
 }
 
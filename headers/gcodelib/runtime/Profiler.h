@@ -0,0 +1,124 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_RUNTIME_PROFILER_H_
+#define GCODELIB_RUNTIME_PROFILER_H_
+
+#include "gcodelib/runtime/Trace.h"
+#include "gcodelib/Statistics.h"
+#include <array>
+#include <chrono>
+#include <iosfwd>
+
+namespace GCodeLib::Runtime {
+
+  struct GCodeProfileCounter {
+    uint64_t instructions = 0;
+    std::chrono::nanoseconds time{0};
+  };
+
+  struct GCodeProfileLine {
+    std::string tag;
+    uint32_t line;
+    GCodeProfileCounter counter;
+  };
+
+  struct GCodeProfileProcedure {
+    int64_t id;
+    uint64_t calls = 0;
+    GCodeProfileCounter inclusive;
+    GCodeProfileCounter exclusive;
+  };
+
+  enum class GCodeProfileMetric {
+    Instructions,
+    Time
+  };
+
+  class GCodeProfiler : private GCodeNullTracer {
+   public:
+    GCodeProfiler(const GCodeIRModule &, std::size_t = DefaultSampleInterval);
+    void reset();
+    const GCodeIRModule &getModule() const;
+    uint64_t getInstructions() const;
+    std::chrono::nanoseconds getTime() const;
+    uint64_t getOpcodeCount(GCodeIROpcode) const;
+    GCodeAllocationStatistics getOpcodeAllocations(GCodeIROpcode) const;
+    std::vector<GCodeProfileLine> getLines() const;
+    std::vector<GCodeProfileProcedure> getProcedures() const;
+    void writeFolded(std::ostream &, GCodeProfileMetric = GCodeProfileMetric::Instructions) const;
+
+    static constexpr std::size_t DefaultSampleInterval = 1024;
+    static constexpr std::size_t OpcodeCount = static_cast<std::size_t>(GCodeIROpcode::Not) + 1;
+
+    friend class GCodeInterpreter;
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Node {
+      int64_t procedure;
+      std::size_t parent;
+      uint64_t calls;
+      GCodeProfileCounter self;
+      std::vector<std::pair<int64_t, std::size_t>> children;
+    };
+
+    void instruction(std::size_t address, const GCodeIRInstruction &instr) {
+      this->account();
+      this->lastOpcode = static_cast<std::size_t>(instr.getOpcode());
+      this->opcodes[this->lastOpcode]++;
+      this->addresses[address].instructions++;
+      this->nodes[this->current].self.instructions++;
+      this->lastAddress = address;
+      if (--this->countdown == 0) {
+        this->sample();
+      }
+    }
+
+    void call(std::size_t, int64_t procedure, std::size_t) {
+      this->account();
+      this->enter(procedure);
+      this->allocationMark = GCodeAllocationCounter::getThreadTotals();
+    }
+
+    void ret(std::size_t, std::size_t) {
+      this->leave();
+    }
+
+    void resume();
+    void suspend();
+    void sample();
+    void account();
+    void enter(int64_t);
+    void leave();
+    GCodeProfileCounter inclusive(std::size_t) const;
+    void writeFolded(std::ostream &, std::size_t, const std::string &, GCodeProfileMetric) const;
+
+    static constexpr std::size_t Root = 0;
+
+    const GCodeIRModule &module;
+    std::size_t sampleInterval;
+    std::size_t countdown;
+    std::size_t lastAddress;
+    Clock::time_point lastSample;
+    std::array<uint64_t, OpcodeCount> opcodes;
+    std::array<GCodeAllocationStatistics, OpcodeCount> opcodeAllocations;
+    std::size_t lastOpcode;
+    GCodeAllocationStatistics allocationMark;
+    std::vector<GCodeProfileCounter> addresses;
+    std::vector<Node> nodes;
+    std::size_t current;
+  };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_RUNTIME_QUEUE_H_
+#define GCODELIB_RUNTIME_QUEUE_H_
+
+#include "gcodelib/Base.h"
+#include <atomic>
+#include <vector>
+
+namespace GCodeLib::Runtime {
+
+  template <typename T>
+  class GCodeSPSCQueue {
+   public:
+    GCodeSPSCQueue(std::size_t capacity)
+      : slots(GCodeSPSCQueue<T>::roundCapacity(capacity)), mask(slots.size() - 1),
+        head(0), tail(0), cachedHead(0), cachedTail(0) {}
+
+    GCodeSPSCQueue(const GCodeSPSCQueue<T> &) = delete;
+    GCodeSPSCQueue<T> &operator=(const GCodeSPSCQueue<T> &) = delete;
+
+    bool tryPush(const T &value) {
+      std::size_t tail = this->tail.load(std::memory_order_relaxed);
+      if (tail - this->cachedHead == this->slots.size()) {
+        this->cachedHead = this->head.load(std::memory_order_acquire);
+        if (tail - this->cachedHead == this->slots.size()) {
+          return false;
+        }
+      }
+      this->slots[tail & this->mask] = value;
+      this->tail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool tryPop(T &value) {
+      std::size_t head = this->head.load(std::memory_order_relaxed);
+      if (head == this->cachedTail) {
+        this->cachedTail = this->tail.load(std::memory_order_acquire);
+        if (head == this->cachedTail) {
+          return false;
+        }
+      }
+      value = this->slots[head & this->mask];
+      this->head.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+    std::size_t size() const {
+      return this->tail.load(std::memory_order_acquire) - this->head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const {
+      return this->size() == 0;
+    }
+
+    std::size_t capacity() const {
+      return this->slots.size();
+    }
+   private:
+    static std::size_t roundCapacity(std::size_t capacity) {
+      std::size_t rounded = 1;
+      while (rounded < capacity) {
+        rounded <<= 1;
+      }
+      return rounded;
+    }
+
+    static constexpr std::size_t CacheLine = 64;
+
+    std::vector<T> slots;
+    std::size_t mask;
+    alignas(CacheLine) std::atomic<std::size_t> head;
+    alignas(CacheLine) std::atomic<std::size_t> tail;
+    alignas(CacheLine) std::size_t cachedHead;
+    alignas(CacheLine) std::size_t cachedTail;
+  };
+}
+
+#endif
\ No newline at end of file
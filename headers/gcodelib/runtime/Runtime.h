@@ -16,8 +16,10 @@
 
 #include "gcodelib/runtime/Storage.h"
 #include "gcodelib/runtime/Config.h"
-#include <stack>
+#include "gcodelib/runtime/Syscall.h"
+#include "gcodelib/runtime/Snapshot.h"
 #include <map>
+#include <vector>
 #include <functional>
 #include <memory>
 
@@ -53,11 +55,20 @@ namespace GCodeLib::Runtime {
     void inot();
 
     GCodeVariableScope &getScope();
+    std::size_t getCallDepth() const;
+    GCodeSyscallArguments &getSyscallArguments();
+
+    GCodeRuntimeSnapshot snapshot(const GCodeRuntimeSnapshot * = nullptr) const;
+    void restore(const GCodeRuntimeSnapshot &);
+    GCodeRuntimeState fork(GCodeVariableScope &, const GCodeRuntimeConfig &) const;
    private:
-    std::stack<GCodeRuntimeValue> stack;
-    std::stack<std::size_t> call_stack;
-    std::stack<std::unique_ptr<GCodeVariableScope>> scopes;
-    GCodeVariableScope *globalScope;
+    GCodeRuntimeState(GCodeVariableScope &, const GCodeRuntimeConfig &, std::size_t);
+
+    GCodeSyscallArguments syscallArgs;
+    GCodeCopyOnWrite<std::vector<GCodeRuntimeValue>> stack;
+    GCodeCopyOnWrite<std::vector<std::size_t>> call_stack;
+    std::unique_ptr<GCodeDenseVariableScope> globalScope;
+    std::vector<GCodeFrameVariableScope> frames;
     std::size_t pc;
     std::reference_wrapper<const GCodeRuntimeConfig> config;
   };
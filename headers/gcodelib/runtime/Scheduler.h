@@ -0,0 +1,148 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_RUNTIME_SCHEDULER_H_
+#define GCODELIB_RUNTIME_SCHEDULER_H_
+
+#include "gcodelib/runtime/Interpreter.h"
+#include "gcodelib/runtime/Queue.h"
+#include "gcodelib/runtime/Error.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace GCodeLib::Runtime {
+
+  struct GCodeJobStatistics {
+    std::size_t slices = 0;
+    std::size_t commands = 0;
+    std::size_t stalls = 0;
+    std::chrono::nanoseconds runTime{0};
+    std::chrono::nanoseconds totalLatency{0};
+    std::chrono::nanoseconds maxLatency{0};
+
+    std::chrono::nanoseconds getMeanLatency() const;
+  };
+
+  struct GCodeSchedulerStatistics {
+    std::size_t jobs = 0;
+    std::size_t steals = 0;
+    GCodeJobStatistics total;
+  };
+
+  class GCodeJobScheduler;
+
+  // The consumer applies popped commands to the system scope. Popping again, or calling complete(),
+  // acknowledges every command popped so far; a job that needs the system scope while commands are
+  // unacknowledged stays blocked until then.
+  class GCodeScheduledJob {
+   public:
+    enum class State {
+      Runnable,
+      Running,
+      Blocked,
+      Finished,
+      Failed,
+      Cancelled
+    };
+
+    GCodeScheduledJob(GCodeJobScheduler &, GCodeInterpreter &, unsigned int, std::size_t, std::size_t);
+    GCodeScheduledJob(const GCodeScheduledJob &) = delete;
+    GCodeScheduledJob &operator=(const GCodeScheduledJob &) = delete;
+
+    bool tryPop(GCodeCommandRecord &);
+    void complete();
+    void cancel();
+    State getState() const;
+    bool isDone() const;
+    unsigned int getPriority() const;
+    GCodeJobStatistics getStatistics() const;
+    std::optional<GCodeRuntimeError> getError() const;
+
+    friend class GCodeJobScheduler;
+   private:
+    bool hasRoom() const;
+    bool canResume() const;
+    bool wake();
+    void resume();
+
+    GCodeJobScheduler &scheduler;
+    GCodeInterpreter &interpreter;
+    unsigned int priority;
+    GCodeSPSCQueue<GCodeCommandRecord> queue;
+    std::vector<GCodeCommandRecord> batch;
+    std::atomic<State> state;
+    std::atomic<bool> cancelled;
+    std::atomic<bool> awaitingAck;
+    std::atomic<uint64_t> published;
+    std::atomic<uint64_t> applied;
+    uint64_t popped;
+    bool released;
+    std::chrono::steady_clock::time_point readySince;
+    mutable std::mutex statisticsMutex;
+    GCodeJobStatistics statistics;
+    std::optional<GCodeRuntimeError> error;
+  };
+
+  class GCodeJobScheduler {
+   public:
+    GCodeJobScheduler(std::size_t = 0, std::size_t = DefaultQuantum);
+    ~GCodeJobScheduler();
+    GCodeJobScheduler(const GCodeJobScheduler &) = delete;
+    GCodeJobScheduler &operator=(const GCodeJobScheduler &) = delete;
+
+    GCodeScheduledJob &submit(GCodeInterpreter &, unsigned int = 1, std::size_t = DefaultQueueCapacity, std::size_t = DefaultBatchSize);
+    void release(GCodeScheduledJob &);
+    void shutdown();
+    std::size_t getWorkerCount() const;
+    std::size_t getQuantum() const;
+    GCodeSchedulerStatistics getStatistics() const;
+
+    static constexpr std::size_t DefaultQuantum = 4096;
+    static constexpr std::size_t DefaultQueueCapacity = 64;
+    static constexpr std::size_t DefaultBatchSize = 16;
+
+    friend class GCodeScheduledJob;
+   private:
+    struct Worker {
+      std::mutex mutex;
+      std::deque<GCodeScheduledJob *> jobs;
+      std::thread thread;
+    };
+
+    void enqueue(GCodeScheduledJob &);
+    GCodeScheduledJob *take(std::size_t);
+    void work(std::size_t);
+    void runSlice(GCodeScheduledJob &);
+    void finish(GCodeScheduledJob &, GCodeScheduledJob::State);
+    void retire(GCodeScheduledJob &);
+
+    std::size_t quantum;
+    std::vector<std::unique_ptr<Worker>> workers;
+    mutable std::mutex jobsMutex;
+    std::vector<std::unique_ptr<GCodeScheduledJob>> jobs;
+    std::size_t retiredJobs;
+    GCodeJobStatistics retired;
+    std::mutex idleMutex;
+    std::condition_variable idle;
+    std::atomic<std::size_t> queued;
+    std::atomic<std::size_t> nextWorker;
+    std::atomic<std::size_t> steals;
+    std::atomic<std::size_t> sleeping;
+    std::atomic<bool> stopping;
+  };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_RUNTIME_SNAPSHOT_H_
+#define GCODELIB_RUNTIME_SNAPSHOT_H_
+
+#include "gcodelib/runtime/Value.h"
+#include <iosfwd>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace GCodeLib::Runtime {
+
+  struct GCodeRuntimeSnapshot {
+    using NumberedEntries = std::vector<std::pair<int64_t, GCodeRuntimeValue>>;
+    using NamedEntries = std::vector<std::pair<std::string, GCodeRuntimeValue>>;
+
+    struct Scope {
+      std::shared_ptr<const NumberedEntries> numbered;
+      std::shared_ptr<const NamedEntries> named;
+    };
+
+    std::size_t pc = 0;
+    std::size_t commands = 0;
+    std::vector<GCodeRuntimeValue> stack;
+    std::vector<std::size_t> callStack;
+    Scope global;
+    std::vector<Scope> frames;
+    std::vector<std::pair<unsigned char, GCodeRuntimeValue>> arguments;
+
+    std::size_t getFootprint() const;
+    void write(std::ostream &) const;
+    static GCodeRuntimeSnapshot read(std::istream &);
+
+    static constexpr char Magic[4] = { 'G', 'C', 'S', 'S' };
+    static constexpr uint16_t Version = 1;
+  };
+}
+
+#endif
\ No newline at end of file
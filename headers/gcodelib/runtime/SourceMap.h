@@ -15,8 +15,11 @@
 #define GCODELIB_RUNTIME_SOURCEMAP_H_
 
 #include "gcodelib/parser/Source.h"
-#include <vector>
+#include <atomic>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <vector>
 
 namespace GCodeLib::Runtime {
 
@@ -35,10 +38,50 @@ namespace GCodeLib::Runtime {
 
   class IRSourceMap {
    public:
+    IRSourceMap() = default;
+    IRSourceMap(const IRSourceMap &);
+    IRSourceMap &operator=(const IRSourceMap &);
+
     void addBlock(const Parser::SourcePosition &, std::size_t, std::size_t);
-    std::optional<Parser::SourcePosition> locate(std::size_t);
+    std::optional<Parser::SourcePosition> locate(std::size_t) const;
+    std::optional<std::size_t> findAddress(uint32_t) const;
+    std::optional<std::size_t> findAddress(const std::string &, uint32_t) const;
+    std::size_t size() const;
+    IRSourceBlock getBlock(std::size_t) const;
+    std::size_t getFootprint() const;
    private:
-    std::vector<IRSourceBlock> blocks;
+    struct Entry {
+      uint32_t start;
+      uint32_t length;
+      uint32_t line;
+      uint32_t tag;
+      uint16_t column;
+      uint8_t checksum;
+    };
+
+    struct Run {
+      uint32_t start;
+      uint32_t entry;
+    };
+
+    struct LineAddress {
+      uint32_t tag;
+      uint32_t line;
+      uint32_t address;
+    };
+
+    void buildIndex() const;
+    Parser::SourcePosition getPosition(const Entry &) const;
+    uint32_t getTagId(const std::string &);
+
+    static constexpr uint32_t NoEntry = UINT32_MAX;
+
+    std::vector<Entry> entries;
+    std::vector<std::string> tags;
+    mutable std::vector<Run> runs;
+    mutable std::vector<LineAddress> lines;
+    mutable std::atomic<bool> indexed{true};
+    mutable std::mutex indexMutex;
   };
 }
 
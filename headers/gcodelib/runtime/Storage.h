@@ -16,7 +16,11 @@
 
 #include "gcodelib/runtime/Value.h"
 #include <map>
+#include <array>
+#include <bitset>
+#include <memory>
 #include <functional>
+#include <vector>
 
 namespace GCodeLib::Runtime {
 
@@ -31,6 +35,40 @@ namespace GCodeLib::Runtime {
     virtual void clear() = 0;
   };
 
+  template <typename T>
+  class GCodeCopyOnWrite {
+   public:
+    GCodeCopyOnWrite()
+      : value(std::make_shared<T>()) {}
+    GCodeCopyOnWrite(const GCodeCopyOnWrite<T> &) = default;
+    GCodeCopyOnWrite<T> &operator=(const GCodeCopyOnWrite<T> &) = default;
+
+    const T &get() const {
+      return *this->value;
+    }
+
+    T &mutate() {
+      if (this->value.use_count() > 1) {
+        this->value = std::make_shared<T>(*this->value);
+      }
+      return *this->value;
+    }
+
+    void reset() {
+      if (this->value.use_count() > 1) {
+        this->value = std::make_shared<T>();
+      } else {
+        *this->value = T();
+      }
+    }
+
+    bool isShared() const {
+      return this->value.use_count() > 1;
+    }
+   private:
+    std::shared_ptr<T> value;
+  };
+
   template <typename T>
   class GCodeScopedDictionary : public GCodeDictionary<T> {
    public:
@@ -46,17 +84,26 @@ namespace GCodeLib::Runtime {
     }
     
     bool has(const T &key) const override {
-      return this->scope.count(key) != 0 ||
+      return this->scope.get().count(key) != 0 ||
         (this->parent != nullptr && this->parent->has(key));
     }
 
     bool hasOwn(const T &key) const {
-      return this->scope.count(key) != 0;
+      return this->scope.get().count(key) != 0;
+    }
+
+    void putOwn(const T &key, const GCodeRuntimeValue &value) {
+      this->assign(key, value);
+    }
+
+    void copyOwn(const GCodeScopedDictionary<T> &other) {
+      this->scope = other.scope;
     }
 
     GCodeRuntimeValue get(const T &key) const override {
-      if (this->scope.count(key) != 0) {
-        return this->scope.at(key);
+      auto it = this->scope.get().find(key);
+      if (it != this->scope.get().end()) {
+        return it->second;
       } else if (this->parent != nullptr) {
         return this->parent->get(key);
       } else {
@@ -65,10 +112,10 @@ namespace GCodeLib::Runtime {
     }
     
     bool put(const T &key, const GCodeRuntimeValue &value) override {
-      if (this->scope.count(key) != 0 ||
+      if (this->scope.get().count(key) != 0 ||
         this->parent == nullptr ||
         !this->parent->has(key)) {
-        this->scope[key] = value;
+        this->assign(key, value);
         return true;
       } else {
         this->parent->put(key, value);
@@ -77,8 +124,8 @@ namespace GCodeLib::Runtime {
     }
 
     bool remove(const T &key) override {
-      if (this->scope.count(key) != 0) {
-        this->scope.erase(key);
+      if (this->scope.get().count(key) != 0) {
+        this->scope.mutate().erase(key);
         return true;
       } else if (this->parent != nullptr) {
         return this->parent->remove(key);
@@ -88,19 +135,62 @@ namespace GCodeLib::Runtime {
     }
 
     void clear() override {
-      this->scope.clear();
+      if (this->scope.get().empty()) {
+        return;
+      }
+      if (this->scope.isShared()) {
+        this->scope.reset();
+      } else {
+        std::map<T, GCodeRuntimeValue> &scope = this->scope.mutate();
+        while (!scope.empty()) {
+          this->spare.nodes.push_back(scope.extract(scope.begin()));
+        }
+      }
     }
 
     typename std::map<T, GCodeRuntimeValue>::const_iterator begin() const {
-      return this->scope.begin();
+      return this->scope.get().begin();
     }
 
     typename std::map<T, GCodeRuntimeValue>::const_iterator end() const {
-      return this->scope.end();
+      return this->scope.get().end();
     }
    private:
+    using Node = typename std::map<T, GCodeRuntimeValue>::node_type;
+
+    // Nodes released by clear() are reused by later inserts, so a frame scope that is cleared and
+    // refilled on every procedure call stops allocating once warmed up. Copies start with no spares.
+    struct SpareNodes {
+      SpareNodes() = default;
+      SpareNodes(const SpareNodes &) {}
+      SpareNodes(SpareNodes &&) = default;
+      SpareNodes &operator=(const SpareNodes &) {
+        return *this;
+      }
+      SpareNodes &operator=(SpareNodes &&) = default;
+
+      std::vector<Node> nodes;
+    };
+
+    void assign(const T &key, const GCodeRuntimeValue &value) {
+      std::map<T, GCodeRuntimeValue> &scope = this->scope.mutate();
+      auto it = scope.find(key);
+      if (it != scope.end()) {
+        it->second = value;
+      } else if (!this->spare.nodes.empty()) {
+        Node node = std::move(this->spare.nodes.back());
+        this->spare.nodes.pop_back();
+        node.key() = key;
+        node.mapped() = value;
+        scope.insert(std::move(node));
+      } else {
+        scope.emplace(key, value);
+      }
+    }
+
     GCodeDictionary<T> *parent;
-    std::map<T, GCodeRuntimeValue> scope;
+    GCodeCopyOnWrite<std::map<T, GCodeRuntimeValue>> scope;
+    SpareNodes spare;
   };
 
   template <typename T>
@@ -187,6 +277,71 @@ namespace GCodeLib::Runtime {
     GCodeDictionary<T> *slave;
   };
 
+  class GCodeLocalDictionary : public GCodeDictionary<int64_t> {
+   public:
+    GCodeLocalDictionary(GCodeDictionary<int64_t> * = nullptr);
+    GCodeDictionary<int64_t> *getParent();
+    const GCodeDictionary<int64_t> *getParent() const;
+    bool has(const int64_t &) const override;
+    bool hasOwn(const int64_t &) const;
+    GCodeRuntimeValue get(const int64_t &) const override;
+    bool put(const int64_t &, const GCodeRuntimeValue &) override;
+    bool remove(const int64_t &) override;
+    void clear() override;
+    void putOwn(const int64_t &, const GCodeRuntimeValue &);
+    void copyOwn(const GCodeLocalDictionary &);
+    void visitOwn(const std::function<void(int64_t, const GCodeRuntimeValue &)> &) const;
+
+    // Procedure arguments are stored starting from #0, so fixed slots cover #0-#30
+    static constexpr std::size_t FixedSlots = 31;
+   private:
+    static constexpr bool isFixed(int64_t key) {
+      return key >= 0 && key < static_cast<int64_t>(FixedSlots);
+    }
+
+    GCodeDictionary<int64_t> *parent;
+    std::bitset<FixedSlots> present;
+    std::array<GCodeRuntimeValue, FixedSlots> fixed;
+    GCodeCopyOnWrite<std::map<int64_t, GCodeRuntimeValue>> overflow;
+  };
+
+  class GCodeDenseDictionary : public GCodeDictionary<int64_t> {
+   public:
+    GCodeDenseDictionary(GCodeDictionary<int64_t> * = nullptr);
+    GCodeDictionary<int64_t> *getParent();
+    const GCodeDictionary<int64_t> *getParent() const;
+    bool has(const int64_t &) const override;
+    bool hasOwn(const int64_t &) const;
+    GCodeRuntimeValue get(const int64_t &) const override;
+    bool put(const int64_t &, const GCodeRuntimeValue &) override;
+    bool remove(const int64_t &) override;
+    void clear() override;
+    void putOwn(const int64_t &, const GCodeRuntimeValue &);
+    void copyOwn(const GCodeDenseDictionary &);
+    void visitOwn(const std::function<void(int64_t, const GCodeRuntimeValue &)> &) const;
+
+    // Covers LinuxCNC numbered parameters #1-#5602, rounded up to whole chunks
+    static constexpr std::size_t ChunkSize = 64;
+    static constexpr std::size_t ChunkCount = 88;
+    static constexpr std::size_t DenseSlots = ChunkSize * ChunkCount;
+   private:
+    struct Chunk {
+      uint64_t present = 0;
+      std::array<GCodeRuntimeValue, ChunkSize> values;
+    };
+
+    static constexpr bool isDense(int64_t key) {
+      return key >= 0 && key < static_cast<int64_t>(DenseSlots);
+    }
+
+    const GCodeRuntimeValue *find(int64_t) const;
+    Chunk &mutableChunk(std::size_t);
+
+    GCodeDictionary<int64_t> *parent;
+    std::array<std::shared_ptr<Chunk>, ChunkCount> chunks;
+    GCodeCopyOnWrite<std::map<int64_t, GCodeRuntimeValue>> sparse;
+  };
+
   class GCodeVariableScope {
    public:
     virtual ~GCodeVariableScope() = default;
@@ -213,6 +368,31 @@ namespace GCodeLib::Runtime {
     GCodeScopedDictionary<int64_t> numbered;
     GCodeScopedDictionary<std::string> named;
   };
+
+  class GCodeDenseVariableScope : public GCodeVariableScope {
+   public:
+    GCodeDenseVariableScope(GCodeVariableScope * = nullptr);
+    GCodeDenseDictionary &getNumbered() override;
+    GCodeScopedDictionary<std::string> &getNamed() override;
+    const GCodeDenseDictionary &getNumbered() const;
+    const GCodeScopedDictionary<std::string> &getNamed() const;
+   private:
+    GCodeDenseDictionary numbered;
+    GCodeScopedDictionary<std::string> named;
+  };
+
+  class GCodeFrameVariableScope : public GCodeVariableScope {
+   public:
+    GCodeFrameVariableScope(GCodeVariableScope * = nullptr);
+    GCodeLocalDictionary &getNumbered() override;
+    GCodeScopedDictionary<std::string> &getNamed() override;
+    const GCodeLocalDictionary &getNumbered() const;
+    const GCodeScopedDictionary<std::string> &getNamed() const;
+    void reset();
+   private:
+    GCodeLocalDictionary numbered;
+    GCodeScopedDictionary<std::string> named;
+  };
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,111 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_RUNTIME_SYSCALL_H_
+#define GCODELIB_RUNTIME_SYSCALL_H_
+
+#include "gcodelib/runtime/Storage.h"
+#include "gcodelib/runtime/IR.h"
+#include <array>
+
+namespace GCodeLib::Runtime {
+
+  class GCodeSyscallArguments {
+   public:
+    static constexpr std::size_t Count = 26;
+
+    GCodeSyscallArguments();
+    void clear();
+    bool put(unsigned char, const GCodeRuntimeValue &);
+    void copyTo(GCodeDictionary<unsigned char> &) const;
+
+    uint32_t getMask() const {
+      return this->mask;
+    }
+
+    const std::array<double, Count> &getValues() const {
+      return this->values;
+    }
+
+    bool has(unsigned char key) const {
+      return (this->mask & GCodeSyscallArguments::bit(key)) != 0;
+    }
+
+    double get(unsigned char key, double defaultValue = 0.0) const {
+      return this->has(key) ? this->values[key - 'A'] : defaultValue;
+    }
+
+    const GCodeRuntimeValue &getValue(unsigned char key) const {
+      return this->has(key) ? this->raw[key - 'A'] : GCodeRuntimeValue::Empty;
+    }
+
+    static constexpr bool isArgument(unsigned char key) {
+      return key >= 'A' && key <= 'Z';
+    }
+
+    static constexpr uint32_t bit(unsigned char key) {
+      return isArgument(key) ? 1U << (key - 'A') : 0;
+    }
+   private:
+    uint32_t mask;
+    std::array<double, Count> values;
+    std::array<GCodeRuntimeValue, Count> raw;
+  };
+
+  struct GCodeCommandRecord {
+    GCodeSyscallType type;
+    double function;
+    uint32_t mask;
+    std::size_t address;
+    std::array<double, GCodeSyscallArguments::Count> values;
+
+    bool has(unsigned char key) const {
+      return (this->mask & GCodeSyscallArguments::bit(key)) != 0;
+    }
+
+    double get(unsigned char key, double defaultValue = 0.0) const {
+      return this->has(key) ? this->values[key - 'A'] : defaultValue;
+    }
+  };
+
+  class GCodeCommandSpan {
+   public:
+    GCodeCommandSpan(const GCodeCommandRecord *data = nullptr, std::size_t length = 0)
+      : data(data), length(length) {}
+
+    const GCodeCommandRecord *begin() const {
+      return this->data;
+    }
+
+    const GCodeCommandRecord *end() const {
+      return this->data + this->length;
+    }
+
+    const GCodeCommandRecord &operator[](std::size_t index) const {
+      return this->data[index];
+    }
+
+    std::size_t size() const {
+      return this->length;
+    }
+
+    bool empty() const {
+      return this->length == 0;
+    }
+   private:
+    const GCodeCommandRecord *data;
+    std::size_t length;
+  };
+}
+
+#endif
\ No newline at end of file
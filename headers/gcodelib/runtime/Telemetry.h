@@ -0,0 +1,84 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_RUNTIME_TELEMETRY_H_
+#define GCODELIB_RUNTIME_TELEMETRY_H_
+
+#include "gcodelib/runtime/Trace.h"
+#include <atomic>
+#include <optional>
+
+namespace GCodeLib::Runtime {
+
+  struct GCodeTelemetrySnapshot {
+    uint64_t instructions = 0;
+    uint64_t commands = 0;
+    std::size_t address = 0;
+    std::size_t callDepth = 0;
+    bool running = false;
+    std::optional<Parser::SourcePosition> position;
+  };
+
+  class GCodeTelemetry : private GCodeNullTracer {
+   public:
+    GCodeTelemetry(const GCodeIRModule &);
+    const GCodeIRModule &getModule() const;
+    GCodeTelemetrySnapshot read() const;
+    uint64_t getInstructions() const;
+    uint64_t getCommands() const;
+
+    friend class GCodeInterpreter;
+   private:
+    void instruction(std::size_t, const GCodeIRInstruction &) {
+      this->instructions++;
+    }
+
+    void syscall(std::size_t address, GCodeSyscallType, const GCodeRuntimeValue &, const GCodeSyscallArguments &) {
+      this->commands++;
+      this->address = address;
+      this->publish();
+    }
+
+    void call(std::size_t, int64_t, std::size_t) {
+      this->depth++;
+    }
+
+    void ret(std::size_t, std::size_t) {
+      if (this->depth > 0) {
+        this->depth--;
+      }
+    }
+
+    void resume();
+    void suspend();
+    void publish();
+
+    const GCodeIRModule &module;
+    uint64_t instructions;
+    uint64_t commands;
+    std::size_t address;
+    std::size_t depth;
+    bool running;
+
+    struct alignas(64) Block {
+      std::atomic<uint32_t> sequence{0};
+      std::atomic<uint64_t> instructions{0};
+      std::atomic<uint64_t> commands{0};
+      std::atomic<std::size_t> address{0};
+      std::atomic<std::size_t> depth{0};
+      std::atomic<bool> running{false};
+    } block;
+  };
+}
+
+#endif
\ No newline at end of file
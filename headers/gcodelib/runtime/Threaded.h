@@ -0,0 +1,81 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_RUNTIME_THREADED_H_
+#define GCODELIB_RUNTIME_THREADED_H_
+
+#include "gcodelib/runtime/Interpreter.h"
+#include "gcodelib/runtime/Queue.h"
+#include "gcodelib/runtime/Error.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace GCodeLib::Runtime {
+
+  struct GCodeQueuedCommand {
+    enum class Type {
+      Command,
+      Error,
+      Finished
+    };
+
+    Type type = Type::Finished;
+    GCodeCommandRecord command;
+    std::optional<GCodeRuntimeError> error;
+  };
+
+  // The consumer applies commands to the system scope. Popping again, or calling complete(), tells the
+  // worker that every command popped so far has been applied; the worker does not touch the system scope
+  // while commands are unacknowledged.
+  class GCodeThreadedRunner {
+   public:
+    GCodeThreadedRunner(GCodeInterpreter &, std::size_t = DefaultQueueCapacity, std::size_t = DefaultBatchSize);
+    ~GCodeThreadedRunner();
+    GCodeThreadedRunner(const GCodeThreadedRunner &) = delete;
+    GCodeThreadedRunner &operator=(const GCodeThreadedRunner &) = delete;
+
+    void start();
+    void stop();
+    bool isRunning() const;
+    bool tryPop(GCodeQueuedCommand &);
+    GCodeQueuedCommand pop();
+    void complete();
+
+    static constexpr std::size_t DefaultQueueCapacity = 1024;
+    static constexpr std::size_t DefaultBatchSize = 64;
+   private:
+    void run();
+    bool publish(const GCodeQueuedCommand &);
+    template <typename Predicate>
+    void wait(std::condition_variable &, std::atomic<bool> &, Predicate);
+    void wake(std::condition_variable &, std::atomic<bool> &);
+
+    GCodeInterpreter &interpreter;
+    GCodeSPSCQueue<GCodeQueuedCommand> queue;
+    std::vector<GCodeCommandRecord> batch;
+    std::thread worker;
+    std::atomic<bool> cancelled;
+    std::atomic<bool> running;
+    uint64_t published;
+    uint64_t popped;
+    std::atomic<uint64_t> applied;
+    std::mutex mutex;
+    std::condition_variable producerSignal;
+    std::condition_variable consumerSignal;
+    std::atomic<bool> producerWaiting;
+    std::atomic<bool> consumerWaiting;
+  };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+#ifndef GCODELIB_RUNTIME_TIMELINE_H_
+#define GCODELIB_RUNTIME_TIMELINE_H_
+
+#include "gcodelib/runtime/Trace.h"
+#include "gcodelib/Timeline.h"
+
+namespace GCodeLib::Runtime {
+
+  class GCodeTimelineTracer : private GCodeNullTracer {
+   public:
+    GCodeTimelineTracer(const GCodeIRModule &, GCodeTimelineSink &, std::size_t = DefaultCallSampleInterval, std::size_t = DefaultSyscallBatchSize);
+    const GCodeIRModule &getModule() const;
+    GCodeTimelineSink &getSink() const;
+    uint64_t getCalls() const;
+    uint64_t getSampledCalls() const;
+    uint64_t getSyscalls() const;
+
+    static constexpr std::size_t DefaultCallSampleInterval = 16;
+    static constexpr std::size_t DefaultSyscallBatchSize = 256;
+
+    friend class GCodeInterpreter;
+   private:
+    using Clock = GCodeTimelineSpan::Clock;
+
+    struct Frame {
+      int64_t procedure;
+      std::size_t address;
+      bool sampled;
+      uint64_t thread;
+      Clock::time_point begin;
+    };
+
+    void syscall(std::size_t, GCodeSyscallType, const GCodeRuntimeValue &, const GCodeSyscallArguments &) {
+      this->syscalls++;
+      if (this->batched++ == 0) {
+        this->batchStart = Clock::now();
+      }
+      if (this->batched == this->batchSize) {
+        this->flush();
+      }
+    }
+
+    void call(std::size_t, int64_t, std::size_t);
+    void ret(std::size_t, std::size_t);
+    void resume();
+    void suspend();
+    void flush();
+
+    const GCodeIRModule &module;
+    GCodeTimelineSink &sink;
+    std::size_t sampleInterval;
+    std::size_t batchSize;
+    uint64_t calls;
+    uint64_t sampledCalls;
+    uint64_t syscalls;
+    std::size_t batched;
+    Clock::time_point batchStart;
+    uint64_t thread;
+    std::vector<Frame> frames;
+  };
+}
+
+#endif
\ No newline at end of file
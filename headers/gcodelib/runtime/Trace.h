@@ -0,0 +1,190 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_RUNTIME_TRACE_H_
+#define GCODELIB_RUNTIME_TRACE_H_
+
+#include "gcodelib/runtime/IR.h"
+#include "gcodelib/runtime/Syscall.h"
+#include <iosfwd>
+#include <vector>
+
+namespace GCodeLib::Runtime {
+
+  enum class GCodeTraceEventType : uint8_t {
+    Instruction = 0,
+    Syscall = 1,
+    Call = 2,
+    Ret = 3,
+    StoreNumbered = 4,
+    StoreNamed = 5
+  };
+
+  struct GCodeTraceEvent {
+    GCodeTraceEventType type;
+    uint8_t code;
+    uint16_t reserved;
+    uint32_t depth;
+    uint64_t address;
+    int64_t operand;
+    double value;
+
+    static constexpr uint32_t mask(GCodeTraceEventType type) {
+      return 1U << static_cast<uint8_t>(type);
+    }
+
+    static constexpr uint32_t All = 0x3f;
+    static constexpr uint32_t Control = All & ~(1U << static_cast<uint8_t>(GCodeTraceEventType::Instruction));
+  };
+
+  // Tracing policy with no effect. The interpreter loop is instantiated per policy,
+  // so policies only need to hide the hooks they are interested in.
+  class GCodeNullTracer {
+   public:
+    void resume() {}
+    void suspend() {}
+    void instruction(std::size_t, const GCodeIRInstruction &) {}
+    void syscall(std::size_t, GCodeSyscallType, const GCodeRuntimeValue &, const GCodeSyscallArguments &) {}
+    void call(std::size_t, int64_t, std::size_t) {}
+    void ret(std::size_t, std::size_t) {}
+    void storeNumbered(std::size_t, int64_t, const GCodeRuntimeValue &) {}
+    void storeNamed(std::size_t, std::size_t, const GCodeRuntimeValue &) {}
+  };
+
+  class GCodeTracer {
+   public:
+    virtual ~GCodeTracer() = default;
+    virtual void resume() {}
+    virtual void suspend() {}
+    virtual void instruction(std::size_t, const GCodeIRInstruction &) {}
+    virtual void syscall(std::size_t, GCodeSyscallType, const GCodeRuntimeValue &, const GCodeSyscallArguments &) {}
+    virtual void call(std::size_t, int64_t, std::size_t) {}
+    virtual void ret(std::size_t, std::size_t) {}
+    virtual void storeNumbered(std::size_t, int64_t, const GCodeRuntimeValue &) {}
+    virtual void storeNamed(std::size_t, std::size_t, const GCodeRuntimeValue &) {}
+  };
+
+  template <typename Sink>
+  class GCodeEventTracer : public GCodeNullTracer {
+   public:
+    GCodeEventTracer(uint32_t filter)
+      : filter(filter), depth(0) {}
+
+    uint32_t getFilter() const {
+      return this->filter;
+    }
+
+    void instruction(std::size_t address, const GCodeIRInstruction &instr) {
+      if (this->filter & GCodeTraceEvent::mask(GCodeTraceEventType::Instruction)) {
+        this->emit(GCodeTraceEventType::Instruction, static_cast<uint8_t>(instr.getOpcode()), address,
+          instr.getValue().asInteger(), instr.getValue().asFloat());
+      }
+    }
+
+    void syscall(std::size_t address, GCodeSyscallType type, const GCodeRuntimeValue &function, const GCodeSyscallArguments &args) {
+      if (this->filter & GCodeTraceEvent::mask(GCodeTraceEventType::Syscall)) {
+        this->emit(GCodeTraceEventType::Syscall, static_cast<uint8_t>(type), address, args.getMask(), function.asFloat());
+      }
+    }
+
+    void call(std::size_t address, int64_t procedure, std::size_t target) {
+      if (this->filter & GCodeTraceEvent::mask(GCodeTraceEventType::Call)) {
+        this->emit(GCodeTraceEventType::Call, 0, address, procedure, static_cast<double>(target));
+      }
+      this->depth++;
+    }
+
+    void ret(std::size_t address, std::size_t target) {
+      if (this->depth > 0) {
+        this->depth--;
+      }
+      if (this->filter & GCodeTraceEvent::mask(GCodeTraceEventType::Ret)) {
+        this->emit(GCodeTraceEventType::Ret, 0, address, static_cast<int64_t>(target), 0.0);
+      }
+    }
+
+    void storeNumbered(std::size_t address, int64_t key, const GCodeRuntimeValue &value) {
+      if (this->filter & GCodeTraceEvent::mask(GCodeTraceEventType::StoreNumbered)) {
+        this->emit(GCodeTraceEventType::StoreNumbered, static_cast<uint8_t>(value.getType()), address, key, value.asFloat());
+      }
+    }
+
+    void storeNamed(std::size_t address, std::size_t symbol, const GCodeRuntimeValue &value) {
+      if (this->filter & GCodeTraceEvent::mask(GCodeTraceEventType::StoreNamed)) {
+        this->emit(GCodeTraceEventType::StoreNamed, static_cast<uint8_t>(value.getType()), address,
+          static_cast<int64_t>(symbol), value.asFloat());
+      }
+    }
+   private:
+    void emit(GCodeTraceEventType type, uint8_t code, std::size_t address, int64_t operand, double value) {
+      static_cast<Sink *>(this)->record(GCodeTraceEvent { type, code, 0, this->depth, address, operand, value });
+    }
+
+    uint32_t filter;
+    uint32_t depth;
+  };
+
+  class GCodeRingBufferTracer : public GCodeEventTracer<GCodeRingBufferTracer> {
+   public:
+    GCodeRingBufferTracer(std::size_t = DefaultCapacity, uint32_t = GCodeTraceEvent::All);
+    std::size_t getCapacity() const;
+    uint64_t getRecorded() const;
+    std::vector<GCodeTraceEvent> getEvents() const;
+    void clear();
+
+    static constexpr std::size_t DefaultCapacity = 4096;
+
+    friend class GCodeEventTracer<GCodeRingBufferTracer>;
+   private:
+    void record(const GCodeTraceEvent &event) {
+      this->events[this->recorded++ & this->mask] = event;
+    }
+
+    std::vector<GCodeTraceEvent> events;
+    std::size_t mask;
+    uint64_t recorded;
+  };
+
+  class GCodeFileTracer : public GCodeEventTracer<GCodeFileTracer> {
+   public:
+    GCodeFileTracer(std::ostream &, uint32_t = GCodeTraceEvent::Control, std::size_t = DefaultBufferSize);
+    ~GCodeFileTracer();
+    GCodeFileTracer(const GCodeFileTracer &) = delete;
+    GCodeFileTracer &operator=(const GCodeFileTracer &) = delete;
+    void suspend();
+    void flush();
+    uint64_t getRecorded() const;
+
+    static std::vector<GCodeTraceEvent> read(std::istream &);
+
+    static constexpr std::size_t DefaultBufferSize = 1024;
+    static constexpr char Magic[4] = { 'G', 'C', 'T', 'R' };
+    static constexpr uint16_t Version = 1;
+
+    friend class GCodeEventTracer<GCodeFileTracer>;
+   private:
+    void record(const GCodeTraceEvent &event) {
+      this->buffer.push_back(event);
+      if (this->buffer.size() == this->bufferSize) {
+        this->flush();
+      }
+    }
+
+    std::ostream &os;
+    std::vector<GCodeTraceEvent> buffer;
+    std::size_t bufferSize;
+    uint64_t recorded;
+  };
+}
+
+#endif
\ No newline at end of file
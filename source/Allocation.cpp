@@ -0,0 +1,178 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "gcodelib/Statistics.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Replacement global allocation functions forwarding to GCodeAllocationCounter. Each block carries
+// its size in a header so that unsized deallocation can be accounted as well.
+
+namespace {
+  constexpr std::size_t HeaderSize = alignof(std::max_align_t);
+
+  struct AlignedHeader {
+    void *block;
+    std::size_t size;
+  };
+
+  void *allocate(std::size_t size) noexcept {
+    void *block = std::malloc(size + HeaderSize);
+    if (block == nullptr) {
+      return nullptr;
+    }
+    *static_cast<std::size_t *>(block) = size;
+    GCodeLib::GCodeAllocationCounter::allocate(size);
+    return static_cast<char *>(block) + HeaderSize;
+  }
+
+  void deallocate(void *ptr) noexcept {
+    if (ptr == nullptr) {
+      return;
+    }
+    void *block = static_cast<char *>(ptr) - HeaderSize;
+    GCodeLib::GCodeAllocationCounter::deallocate(*static_cast<std::size_t *>(block));
+    std::free(block);
+  }
+
+  // Over-aligned blocks keep the malloc'd pointer and the size right below the aligned address
+  void *allocate(std::size_t size, std::align_val_t alignment) noexcept {
+    std::size_t align = static_cast<std::size_t>(alignment);
+    void *block = std::malloc(size + align + sizeof(AlignedHeader));
+    if (block == nullptr) {
+      return nullptr;
+    }
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(block) + sizeof(AlignedHeader);
+    address = (address + align - 1) & ~static_cast<std::uintptr_t>(align - 1);
+    AlignedHeader *header = reinterpret_cast<AlignedHeader *>(address) - 1;
+    header->block = block;
+    header->size = size;
+    GCodeLib::GCodeAllocationCounter::allocate(size);
+    return reinterpret_cast<void *>(address);
+  }
+
+  void deallocate(void *ptr, std::align_val_t) noexcept {
+    if (ptr == nullptr) {
+      return;
+    }
+    AlignedHeader *header = static_cast<AlignedHeader *>(ptr) - 1;
+    GCodeLib::GCodeAllocationCounter::deallocate(header->size);
+    std::free(header->block);
+  }
+
+  template <typename... Alignment>
+  void *allocateOrThrow(std::size_t size, Alignment... alignment) {
+    while (true) {
+      void *ptr = allocate(size, alignment...);
+      if (ptr != nullptr) {
+        return ptr;
+      }
+      std::new_handler handler = std::get_new_handler();
+      if (handler == nullptr) {
+        throw std::bad_alloc();
+      }
+      handler();
+    }
+  }
+
+  template <typename... Alignment>
+  void *allocateOrNull(std::size_t size, Alignment... alignment) noexcept {
+    try {
+      return allocateOrThrow(size, alignment...);
+    } catch (...) {
+      return nullptr;
+    }
+  }
+}
+
+void *operator new(std::size_t size) {
+  return allocateOrThrow(size);
+}
+
+void *operator new[](std::size_t size) {
+  return allocateOrThrow(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return allocateOrNull(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return allocateOrNull(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return allocateOrThrow(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  return allocateOrThrow(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  return allocateOrNull(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  return allocateOrNull(size, alignment);
+}
+
+void operator delete(void *ptr) noexcept {
+  deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+  deallocate(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+  deallocate(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+  deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t alignment) noexcept {
+  deallocate(ptr, alignment);
+}
+
+void operator delete[](void *ptr, std::align_val_t alignment) noexcept {
+  deallocate(ptr, alignment);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t alignment) noexcept {
+  deallocate(ptr, alignment);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t alignment) noexcept {
+  deallocate(ptr, alignment);
+}
+
+void operator delete(void *ptr, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  deallocate(ptr, alignment);
+}
+
+void operator delete[](void *ptr, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  deallocate(ptr, alignment);
+}
\ No newline at end of file
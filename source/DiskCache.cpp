@@ -0,0 +1,195 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "gcodelib/DiskCache.h"
+#include "gcodelib/ModuleCache.h"
+#include "gcodelib/runtime/Bytecode.h"
+#include "gcodelib/runtime/Error.h"
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <typeinfo>
+
+namespace GCodeLib {
+
+  static constexpr auto ManifestMagic = "GCODELIB-CACHE";
+
+  static bool read_file(const std::string &path, std::string &content) {
+    std::ifstream is(path, std::ios::binary);
+    if (!is) {
+      return false;
+    }
+    std::stringstream ss;
+    ss << is.rdbuf();
+    content = ss.str();
+    return true;
+  }
+
+  static void write_field(std::ostream &os, const std::string &field) {
+    os << field.size() << ':' << field << '\n';
+  }
+
+  static bool read_field(std::istream &is, std::string &field) {
+    std::size_t length;
+    char separator;
+    if (!(is >> length >> separator) || separator != ':') {
+      return false;
+    }
+    // The length comes from the file, so it is checked against the bytes left before allocating
+    std::streamoff position = is.tellg();
+    is.seekg(0, std::ios::end);
+    std::streamoff end = is.tellg();
+    is.seekg(position);
+    if (position < 0 || end < position || length > static_cast<std::size_t>(end - position)) {
+      return false;
+    }
+    field.resize(length);
+    return static_cast<bool>(is.read(field.data(), length));
+  }
+
+  GCodeDiskCache::GCodeDiskCache(const std::string &directory)
+    : directory(directory) {}
+
+  std::unique_ptr<Runtime::GCodeIRModule> GCodeDiskCache::compile(GCodeCompilerFrontend &frontend, std::istream &is, const std::string &tag, const std::vector<std::string> &dependencies) {
+    std::stringstream ss;
+    ss << is.rdbuf();
+    std::string source = ss.str();
+    std::string dialect = typeid(frontend).name();
+    std::string entry = this->getEntryPath(source, dialect, tag);
+    std::unique_ptr<Runtime::GCodeIRModule> module = this->lookup(entry, source, dialect, tag);
+    if (module) {
+      this->statistics.hits++;
+      return module;
+    }
+    this->statistics.misses++;
+    std::vector<Dependency> deps;
+    for (const auto &path : dependencies) {
+      std::string content;
+      if (!read_file(path, content)) {
+        throw Runtime::GCodeRuntimeError("Unable to read dependency '" + path + "'");
+      }
+      deps.push_back(Dependency { path, std::move(content) });
+    }
+    std::stringstream input(source);
+    module = frontend.compile(input, tag);
+    if (module->linked()) {
+      module->freeze();
+    }
+    this->store(entry, source, dialect, tag, deps, *module);
+    return module;
+  }
+
+  std::unique_ptr<Runtime::GCodeIRModule> GCodeDiskCache::compileFile(GCodeCompilerFrontend &frontend, const std::string &path, const std::vector<std::string> &dependencies) {
+    std::ifstream is(path, std::ios::binary);
+    if (!is) {
+      throw Runtime::GCodeRuntimeError("Unable to open '" + path + "'");
+    }
+    return this->compile(frontend, is, path, dependencies);
+  }
+
+  const std::string &GCodeDiskCache::getDirectory() const {
+    return this->directory;
+  }
+
+  const GCodeDiskCacheStatistics &GCodeDiskCache::getStatistics() const {
+    return this->statistics;
+  }
+
+  std::string GCodeDiskCache::getEntryPath(const std::string &source, const std::string &dialect, const std::string &tag) const {
+    std::string key = dialect;
+    key.push_back('\0');
+    key.append(tag);
+    key.push_back('\0');
+    key.append(source);
+    std::stringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << GCodeModuleCache::hash(key) << ".gcir";
+    return (std::filesystem::path(this->directory) / name.str()).string();
+  }
+
+  std::unique_ptr<Runtime::GCodeIRModule> GCodeDiskCache::lookup(const std::string &entry, const std::string &source, const std::string &dialect, const std::string &tag) {
+    std::ifstream is(entry, std::ios::binary);
+    if (!is) {
+      return nullptr;
+    }
+    // Entry names are only hashes, so the manifest keeps the full source and dependency contents to compare against
+    std::string magic, marker, storedSource, storedDialect, storedTag;
+    uint32_t version = 0;
+    std::size_t dependencies = 0;
+    bool valid = (is >> magic >> version) && magic == ManifestMagic && version == GCodeDiskCache::Version &&
+      read_field(is, storedSource) && storedSource == source &&
+      read_field(is, storedDialect) && storedDialect == dialect &&
+      read_field(is, storedTag) && storedTag == tag &&
+      (is >> dependencies);
+    for (std::size_t i = 0; valid && i < dependencies; i++) {
+      std::string path, storedContent, content;
+      valid = read_field(is, path) && read_field(is, storedContent) &&
+        read_file(path, content) && content == storedContent;
+    }
+    valid = valid && (is >> marker) && marker == "bytecode" && is.get() == '\n';
+    if (!valid) {
+      this->statistics.invalidations++;
+      return nullptr;
+    }
+    std::size_t offset = static_cast<std::size_t>(is.tellg());
+    is.close();
+    try {
+      return Runtime::GCodeBytecodeReader().load(entry, offset);
+    } catch (const Runtime::GCodeRuntimeError &) {
+      this->statistics.invalidations++;
+      return nullptr;
+    }
+  }
+
+  void GCodeDiskCache::store(const std::string &entry, const std::string &source, const std::string &dialect, const std::string &tag,
+    const std::vector<Dependency> &dependencies, const Runtime::GCodeIRModule &module) {
+    std::random_device random;
+    std::stringstream suffix;
+    suffix << '.' << std::hex << random() << random() << ".tmp";
+    std::string temporary = entry + suffix.str();
+    std::error_code error;
+    std::filesystem::create_directories(this->directory, error);
+    try {
+      std::ofstream os(temporary, std::ios::binary | std::ios::trunc);
+      if (!os) {
+        return;
+      }
+      os << ManifestMagic << ' ' << GCodeDiskCache::Version << '\n';
+      write_field(os, source);
+      write_field(os, dialect);
+      write_field(os, tag);
+      os << dependencies.size() << '\n';
+      for (const auto &dependency : dependencies) {
+        write_field(os, dependency.path);
+        write_field(os, dependency.content);
+      }
+      os << "bytecode\n";
+      Runtime::GCodeBytecodeWriter().write(module, os);
+      os.close();
+      if (!os) {
+        std::filesystem::remove(temporary, error);
+        return;
+      }
+    } catch (const Runtime::GCodeRuntimeError &) {
+      std::filesystem::remove(temporary, error);
+      return;
+    }
+    std::filesystem::rename(temporary, entry, error);
+    if (error) {
+      std::filesystem::remove(temporary, error);
+    } else {
+      this->statistics.writes++;
+    }
+  }
+}
\ No newline at end of file
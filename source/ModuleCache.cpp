@@ -0,0 +1,153 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "gcodelib/ModuleCache.h"
+#include <sstream>
+#include <tuple>
+#include <typeinfo>
+
+namespace GCodeLib {
+
+  bool GCodeModuleKey::operator<(const GCodeModuleKey &other) const {
+    return std::tie(this->hash, this->length, this->dialect, this->tag) <
+      std::tie(other.hash, other.length, other.dialect, other.tag);
+  }
+
+  GCodeModuleCache::GCodeModuleCache(std::size_t capacity, std::size_t memoryLimit)
+    : capacity(capacity > 0 ? capacity : 1), memoryLimit(memoryLimit) {}
+
+  GCodeModuleCache::ModulePtr GCodeModuleCache::compile(GCodeCompilerFrontend &frontend, std::istream &is, const std::string &tag) {
+    std::stringstream ss;
+    ss << is.rdbuf();
+    return this->compile(frontend, ss.str(), tag);
+  }
+
+  GCodeModuleCache::ModulePtr GCodeModuleCache::compile(GCodeCompilerFrontend &frontend, const std::string &source, const std::string &tag) {
+    GCodeModuleKey key { GCodeModuleCache::hash(source), source.size(), typeid(frontend).name(), tag };
+    std::promise<ModulePtr> promise;
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto entry = this->entries.find(key);
+    if (entry != this->entries.end() && entry->second.source == source) {
+      this->statistics.hits++;
+      this->recent.splice(this->recent.begin(), this->recent, entry->second.position);
+      std::shared_future<ModulePtr> module = entry->second.module;
+      lock.unlock();
+      return module.get();
+    } else if (entry != this->entries.end()) {
+      // Hash collision with a different program: compile it without displacing the cached one
+      this->statistics.misses++;
+      lock.unlock();
+      return this->translate(frontend, source, tag);
+    }
+    this->statistics.misses++;
+    this->recent.push_front(key);
+    this->entries.emplace(key, Entry { source, promise.get_future().share(), this->recent.begin(), 0, false });
+    lock.unlock();
+    try {
+      ModulePtr module = this->translate(frontend, source, tag);
+      lock.lock();
+      entry = this->entries.find(key);
+      if (entry != this->entries.end()) {
+        entry->second.footprint = module->getFootprint();
+        entry->second.ready = true;
+        this->statistics.footprint += entry->second.footprint;
+        this->evict();
+      }
+      lock.unlock();
+      promise.set_value(module);
+      return module;
+    } catch (...) {
+      if (!lock.owns_lock()) {
+        lock.lock();
+      }
+      entry = this->entries.find(key);
+      if (entry != this->entries.end() && !entry->second.ready) {
+        this->recent.erase(entry->second.position);
+        this->entries.erase(entry);
+      }
+      lock.unlock();
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+  }
+
+  void GCodeModuleCache::clear() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->entries.clear();
+    this->recent.clear();
+    this->statistics.footprint = 0;
+  }
+
+  GCodeModuleCacheStatistics GCodeModuleCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    GCodeModuleCacheStatistics result = this->statistics;
+    result.entries = this->entries.size();
+    return result;
+  }
+
+  uint64_t GCodeModuleCache::hash(const std::string &content) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char chr : content) {
+      hash ^= chr;
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  GCodeModuleCache::ModulePtr GCodeModuleCache::translate(GCodeCompilerFrontend &frontend, const std::string &source, const std::string &tag) {
+    // Frontends keep translator and mangler state, so misses on a shared frontend take turns
+    std::unique_lock<std::mutex> lock(this->mutex);
+    FrontendLock &frontendLock = this->frontends[&frontend];
+    frontendLock.users++;
+    lock.unlock();
+    auto release = [&]() {
+      lock.lock();
+      if (--frontendLock.users == 0) {
+        this->frontends.erase(&frontend);
+      }
+      lock.unlock();
+    };
+    try {
+      std::shared_ptr<Runtime::GCodeIRModule> module;
+      {
+        std::lock_guard<std::mutex> compileLock(frontendLock.mutex);
+        std::istringstream is(source);
+        module = frontend.compile(is, tag);
+      }
+      if (module->linked()) {
+        module->freeze();
+      }
+      release();
+      return module;
+    } catch (...) {
+      release();
+      throw;
+    }
+  }
+
+  void GCodeModuleCache::evict() {
+    auto position = this->recent.end();
+    while (position != this->recent.begin() &&
+      (this->entries.size() > this->capacity || (this->memoryLimit > 0 && this->statistics.footprint > this->memoryLimit))) {
+      --position;
+      auto entry = this->entries.find(*position);
+      if (!entry->second.ready) {
+        continue;
+      }
+      this->statistics.footprint -= entry->second.footprint;
+      this->statistics.evictions++;
+      this->entries.erase(entry);
+      position = this->recent.erase(position);
+    }
+  }
+}
\ No newline at end of file
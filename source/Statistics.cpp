@@ -0,0 +1,240 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "gcodelib/Statistics.h"
+#include <algorithm>
+#include <iostream>
+
+namespace GCodeLib {
+
+  static thread_local GCodeAllocationCounter *activeCounter = nullptr;
+  static thread_local GCodeAllocationStatistics threadTotals;
+
+  GCodeAllocationStatistics GCodeAllocationStatistics::operator-(const GCodeAllocationStatistics &other) const {
+    return GCodeAllocationStatistics { this->allocations - other.allocations, this->bytes - other.bytes };
+  }
+
+  GCodeAllocationStatistics &GCodeAllocationStatistics::operator+=(const GCodeAllocationStatistics &other) {
+    this->allocations += other.allocations;
+    this->bytes += other.bytes;
+    return *this;
+  }
+
+  GCodeAllocationCounter::GCodeAllocationCounter()
+    : previous(activeCounter), allocations(0), allocated(0), current(0), peak(0) {
+    activeCounter = this;
+  }
+
+  GCodeAllocationCounter::~GCodeAllocationCounter() {
+    activeCounter = this->previous;
+  }
+
+  std::size_t GCodeAllocationCounter::getAllocations() const {
+    return this->allocations;
+  }
+
+  std::size_t GCodeAllocationCounter::getAllocatedBytes() const {
+    return this->allocated;
+  }
+
+  std::size_t GCodeAllocationCounter::getPeakBytes() const {
+    return static_cast<std::size_t>(this->peak);
+  }
+
+  void GCodeAllocationCounter::allocate(std::size_t size) {
+    threadTotals.allocations++;
+    threadTotals.bytes += size;
+    for (GCodeAllocationCounter *counter = activeCounter; counter != nullptr; counter = counter->previous) {
+      counter->allocations++;
+      counter->allocated += size;
+      counter->current += static_cast<int64_t>(size);
+      counter->peak = std::max(counter->peak, counter->current);
+    }
+  }
+
+  void GCodeAllocationCounter::deallocate(std::size_t size) {
+    for (GCodeAllocationCounter *counter = activeCounter; counter != nullptr; counter = counter->previous) {
+      counter->current -= static_cast<int64_t>(size);
+    }
+  }
+
+  GCodeAllocationStatistics GCodeAllocationCounter::getThreadTotals() {
+    return threadTotals;
+  }
+
+  bool GCodeAllocationCounter::isInstrumented() {
+    GCodeAllocationCounter probe;
+    void *ptr = ::operator new(1);
+    ::operator delete(ptr);
+    return probe.getAllocations() > 0;
+  }
+
+  namespace {
+    class GCodeNodeCounter : public Parser::GCodeNode::Visitor {
+     public:
+      std::size_t count = 0;
+
+      void visit(const Parser::GCodeNoOperation &) override {
+        this->count++;
+      }
+
+      void visit(const Parser::GCodeConstantValue &) override {
+        this->count++;
+      }
+
+      void visit(const Parser::GCodeNamedVariable &) override {
+        this->count++;
+      }
+
+      void visit(const Parser::GCodeNumberedVariable &) override {
+        this->count++;
+      }
+
+      void visit(const Parser::GCodeUnaryOperation &node) override {
+        this->count++;
+        node.getArgument().visit(*this);
+      }
+
+      void visit(const Parser::GCodeBinaryOperation &node) override {
+        this->count++;
+        node.getLeftArgument().visit(*this);
+        node.getRightArgument().visit(*this);
+      }
+
+      void visit(const Parser::GCodeFunctionCall &node) override {
+        this->count++;
+        std::vector<std::reference_wrapper<const Parser::GCodeNode>> args;
+        node.getArguments(args);
+        this->visitAll(args);
+      }
+
+      void visit(const Parser::GCodeWord &node) override {
+        this->count++;
+        node.getValue().visit(*this);
+      }
+
+      void visit(const Parser::GCodeCommand &node) override {
+        this->count++;
+        node.getCommand().visit(*this);
+        std::vector<std::reference_wrapper<const Parser::GCodeWord>> params;
+        node.getParameters(params);
+        for (auto param : params) {
+          param.get().visit(*this);
+        }
+      }
+
+      void visit(const Parser::GCodeBlock &node) override {
+        this->count++;
+        std::vector<std::reference_wrapper<const Parser::GCodeNode>> content;
+        node.getContent(content);
+        this->visitAll(content);
+      }
+
+      void visit(const Parser::GCodeNamedStatement &node) override {
+        this->count++;
+        node.getStatement().visit(*this);
+      }
+
+      void visit(const Parser::GCodeProcedureDefinition &node) override {
+        this->count++;
+        node.getBody().visit(*this);
+        std::vector<std::reference_wrapper<const Parser::GCodeNode>> retValues;
+        node.getReturnValues(retValues);
+        this->visitAll(retValues);
+      }
+
+      void visit(const Parser::GCodeProcedureReturn &node) override {
+        this->count++;
+        std::vector<std::reference_wrapper<const Parser::GCodeNode>> retValues;
+        node.getReturnValues(retValues);
+        this->visitAll(retValues);
+      }
+
+      void visit(const Parser::GCodeProcedureCall &node) override {
+        this->count++;
+        node.getProcedureId().visit(*this);
+        std::vector<std::reference_wrapper<const Parser::GCodeNode>> args;
+        node.getArguments(args);
+        this->visitAll(args);
+      }
+
+      void visit(const Parser::GCodeConditional &node) override {
+        this->count++;
+        node.getCondition().visit(*this);
+        node.getThenBody().visit(*this);
+        if (node.getElseBody()) {
+          node.getElseBody()->visit(*this);
+        }
+      }
+
+      void visit(const Parser::GCodeWhileLoop &node) override {
+        this->count++;
+        node.getCondition().visit(*this);
+        node.getBody().visit(*this);
+      }
+
+      void visit(const Parser::GCodeRepeatLoop &node) override {
+        this->count++;
+        node.getCounter().visit(*this);
+        node.getBody().visit(*this);
+      }
+
+      void visit(const Parser::GCodeLoopControl &) override {
+        this->count++;
+      }
+
+      void visit(const Parser::GCodeNumberedVariableAssignment &node) override {
+        this->count++;
+        node.getValue().visit(*this);
+      }
+
+      void visit(const Parser::GCodeNamedVariableAssignment &node) override {
+        this->count++;
+        node.getValue().visit(*this);
+      }
+     private:
+      void visitAll(const std::vector<std::reference_wrapper<const Parser::GCodeNode>> &nodes) {
+        for (auto node : nodes) {
+          node.get().visit(*this);
+        }
+      }
+    };
+  }
+
+  std::chrono::nanoseconds GCodeCompilerStatistics::getTotalTime() const {
+    return this->scan + this->parse + this->validate + this->translate;
+  }
+
+  std::size_t GCodeCompilerStatistics::countNodes(const Parser::GCodeNode &root) {
+    GCodeNodeCounter counter;
+    root.visit(counter);
+    return counter.count;
+  }
+
+  std::ostream &operator<<(std::ostream &os, const GCodeCompilerStatistics &stats) {
+    os << "scan " << stats.scan.count() << " ns, "
+      << "parse " << stats.parse.count() << " ns, "
+      << "validate " << stats.validate.count() << " ns, "
+      << "translate " << stats.translate.count() << " ns; "
+      << stats.tokens << " tokens, "
+      << stats.nodes << " nodes, "
+      << stats.instructions << " instructions (" << stats.moduleBytes << " bytes), "
+      << stats.sourceMapBlocks << " source blocks (" << stats.sourceMapBytes << " bytes), "
+      << stats.allocations << " allocations (scan " << stats.scanMemory.allocations
+      << ", parse " << stats.parseMemory.allocations
+      << ", validate " << stats.validateMemory.allocations
+      << ", translate " << stats.translateMemory.allocations << "), "
+      << stats.peakBytes << " peak bytes";
+    return os;
+  }
+}
\ No newline at end of file
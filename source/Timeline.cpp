@@ -0,0 +1,94 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+#include "gcodelib/Timeline.h"
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace GCodeLib {
+
+  static void write_json_string(std::ostream &os, const char *str) {
+    os << '\"';
+    for (; *str != '\0'; str++) {
+      char chr = *str;
+      if (chr == '\"' || chr == '\\') {
+        os << '\\' << chr;
+      } else if (static_cast<unsigned char>(chr) < 0x20) {
+        os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(chr) << std::dec << std::setfill(' ');
+      } else {
+        os << chr;
+      }
+    }
+    os << '\"';
+  }
+
+  static double microseconds(std::chrono::nanoseconds duration) {
+    return static_cast<double>(duration.count()) / 1000.0;
+  }
+
+  uint64_t GCodeTimelineSink::currentThread() {
+    static std::atomic<uint64_t> threads{0};
+    thread_local uint64_t thread = ++threads;
+    return thread;
+  }
+
+  GCodeChromeTraceWriter::GCodeChromeTraceWriter(std::ostream &os, uint64_t process)
+    : os(os), process(process), origin(GCodeTimelineSpan::Clock::now()), spans(0), closed(false) {
+    this->os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+  }
+
+  GCodeChromeTraceWriter::~GCodeChromeTraceWriter() {
+    this->close();
+  }
+
+  void GCodeChromeTraceWriter::record(const GCodeTimelineSpan &span) {
+    std::stringstream event;
+    event << "{\"name\": ";
+    write_json_string(event, span.name.c_str());
+    event << ", \"cat\": ";
+    write_json_string(event, span.category);
+    event << std::fixed << std::setprecision(3)
+      << ", \"ph\": \"X\", \"ts\": " << microseconds(span.begin - this->origin)
+      << ", \"dur\": " << microseconds(span.duration)
+      << ", \"pid\": " << this->process
+      << ", \"tid\": " << span.thread;
+    if (!span.args.empty()) {
+      event << ", \"args\": {";
+      for (std::size_t i = 0; i < span.args.size(); i++) {
+        event << (i == 0 ? "" : ", ");
+        write_json_string(event, span.args[i].first);
+        event << ": " << span.args[i].second;
+      }
+      event << "}";
+    }
+    event << "}";
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->closed) {
+      this->os << (this->spans++ == 0 ? "\n  " : ",\n  ") << event.str();
+    }
+  }
+
+  std::size_t GCodeChromeTraceWriter::getSpans() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->spans;
+  }
+
+  void GCodeChromeTraceWriter::close() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->closed) {
+      this->os << (this->spans == 0 ? "" : "\n") << "]}" << std::endl;
+      this->closed = true;
+    }
+  }
+}
\ No newline at end of file
@@ -0,0 +1,465 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "gcodelib/runtime/Bytecode.h"
+#include "gcodelib/runtime/Error.h"
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <sstream>
+
+namespace GCodeLib::Runtime {
+
+  namespace {
+
+    struct FileHeader {
+      char magic[4];
+      uint16_t version;
+      uint16_t byteOrder;
+      uint32_t sectionCount;
+      uint32_t reserved;
+      uint64_t checksum;
+    };
+
+    struct SectionHeader {
+      uint32_t type;
+      uint32_t reserved;
+      uint64_t offset;
+      uint64_t length;
+    };
+
+    struct CodeRecord {
+      uint8_t opcode;
+      uint8_t type;
+      uint8_t reserved[6];
+      uint64_t operand;
+    };
+
+    static_assert(sizeof(FileHeader) == 24);
+    static_assert(sizeof(SectionHeader) == 24);
+    static_assert(sizeof(CodeRecord) == 16);
+
+    constexpr std::size_t SectionAlignment = 8;
+
+    class ByteBuffer {
+     public:
+      template <typename T>
+      void put(const T &value) {
+        this->data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+      }
+
+      void putVarint(uint64_t value) {
+        while (value >= 0x80) {
+          this->data.push_back(static_cast<char>((value & 0x7f) | 0x80));
+          value >>= 7;
+        }
+        this->data.push_back(static_cast<char>(value));
+      }
+
+      void putBytes(const std::string &bytes) {
+        this->data.append(bytes);
+      }
+
+      void align(std::size_t alignment) {
+        while (this->data.size() % alignment != 0) {
+          this->data.push_back('\0');
+        }
+      }
+
+      const std::string &getData() const {
+        return this->data;
+      }
+     private:
+      std::string data;
+    };
+
+    class ByteCursor {
+     public:
+      ByteCursor(const char *data, std::size_t length)
+        : data(data), length(length), offset(0) {}
+
+      template <typename T>
+      T get() {
+        T value;
+        std::memcpy(&value, this->take(sizeof(T)), sizeof(T));
+        return value;
+      }
+
+      uint64_t getVarint() {
+        uint64_t value = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+          uint8_t byte = this->get<uint8_t>();
+          value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+          if ((byte & 0x80) == 0) {
+            return value;
+          }
+        }
+        throw GCodeRuntimeError("Malformed bytecode: varint overflow");
+      }
+
+      std::size_t remaining() const {
+        return this->length - this->offset;
+      }
+
+      // Record counts are untrusted, so they are checked against what the section can hold before anything is allocated
+      std::size_t getCount(std::size_t recordSize) {
+        uint32_t count = this->get<uint32_t>();
+        if (count > this->remaining() / recordSize) {
+          throw GCodeRuntimeError("Malformed bytecode: record count exceeds section length");
+        }
+        return count;
+      }
+
+      const char *take(std::size_t count) {
+        if (count > this->length - this->offset) {
+          throw GCodeRuntimeError("Malformed bytecode: unexpected end of section");
+        }
+        const char *ptr = this->data + this->offset;
+        this->offset += count;
+        return ptr;
+      }
+     private:
+      const char *data;
+      std::size_t length;
+      std::size_t offset;
+    };
+
+    class StringTable {
+     public:
+      uint32_t index(const std::string &str) {
+        auto it = this->indices.find(str);
+        if (it != this->indices.end()) {
+          return it->second;
+        }
+        uint32_t idx = static_cast<uint32_t>(this->strings.size());
+        this->indices[str] = idx;
+        this->strings.push_back(str);
+        return idx;
+      }
+
+      void write(ByteBuffer &buffer) const {
+        buffer.put<uint32_t>(static_cast<uint32_t>(this->strings.size()));
+        for (const auto &str : this->strings) {
+          buffer.put<uint32_t>(static_cast<uint32_t>(str.size()));
+          buffer.putBytes(str);
+        }
+      }
+     private:
+      std::map<std::string, uint32_t> indices;
+      std::vector<std::string> strings;
+    };
+
+    uint64_t checksum(const char *data, std::size_t length) {
+      uint64_t hash = 14695981039346656037ULL;
+      for (std::size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+      }
+      return hash;
+    }
+
+    uint64_t zigzag(int64_t value) {
+      return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value) {
+      return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    enum class OperandType : uint8_t {
+      None = 0,
+      Integer = 1,
+      Float = 2,
+      String = 3
+    };
+
+    const std::string &string_at(const std::vector<std::string> &strings, uint64_t index) {
+      if (index >= strings.size()) {
+        throw GCodeRuntimeError("Malformed bytecode: string index out of range");
+      }
+      return strings[index];
+    }
+  }
+
+  void GCodeBytecodeWriter::write(const GCodeIRModule &module, std::ostream &os) {
+    StringTable strings;
+    ByteBuffer code, symbols, labels, procedures, sourceMap;
+    for (const auto &instr : module.code) {
+      CodeRecord record {};
+      record.opcode = static_cast<uint8_t>(instr.getOpcode());
+      const GCodeRuntimeValue &value = instr.getValue();
+      switch (value.getType()) {
+        case GCodeRuntimeValue::Type::None:
+          record.type = static_cast<uint8_t>(OperandType::None);
+          break;
+        case GCodeRuntimeValue::Type::Integer:
+          record.type = static_cast<uint8_t>(OperandType::Integer);
+          record.operand = static_cast<uint64_t>(value.getInteger());
+          break;
+        case GCodeRuntimeValue::Type::Float: {
+          double real = value.getFloat();
+          record.type = static_cast<uint8_t>(OperandType::Float);
+          std::memcpy(&record.operand, &real, sizeof(double));
+        } break;
+        case GCodeRuntimeValue::Type::String:
+          record.type = static_cast<uint8_t>(OperandType::String);
+          record.operand = strings.index(value.getString());
+          break;
+      }
+      code.put(record);
+    }
+
+    symbols.put<uint32_t>(static_cast<uint32_t>(module.symbols.size()));
+    for (const auto &kv : module.symbols) {
+      symbols.put<uint64_t>(kv.first);
+      symbols.put<uint32_t>(strings.index(kv.second));
+    }
+
+    labels.put<uint32_t>(static_cast<uint32_t>(module.labels.size()));
+    for (const auto &kv : module.labels) {
+      labels.put<uint32_t>(strings.index(kv.first));
+      labels.put<uint8_t>(kv.second->bound() ? 1 : 0);
+      labels.put<uint64_t>(kv.second->bound() ? kv.second->getAddress() : 0);
+    }
+
+    procedures.put<uint32_t>(static_cast<uint32_t>(module.procedures.size()));
+    for (const auto &kv : module.procedures) {
+      const std::string *name = nullptr;
+      for (const auto &label : module.labels) {
+        if (label.second == kv.second) {
+          name = &label.first;
+          break;
+        }
+      }
+      if (name == nullptr) {
+        throw GCodeRuntimeError("Procedure " + std::to_string(kv.first) + " has no named label");
+      }
+      procedures.put<int64_t>(kv.first);
+      procedures.put<uint32_t>(strings.index(*name));
+    }
+
+    sourceMap.putVarint(module.sourceMap.size());
+    int64_t lastStart = 0;
+    int64_t lastLine = 0;
+    for (std::size_t i = 0; i < module.sourceMap.size(); i++) {
+      IRSourceBlock block = module.sourceMap.getBlock(i);
+      const Parser::SourcePosition &position = block.getSourcePosition();
+      int64_t start = static_cast<int64_t>(block.getStartAddress());
+      int64_t line = static_cast<int64_t>(position.getLine());
+      sourceMap.putVarint(zigzag(start - lastStart));
+      sourceMap.putVarint(block.getLength());
+      sourceMap.putVarint(strings.index(position.getTag()));
+      sourceMap.putVarint(zigzag(line - lastLine));
+      sourceMap.putVarint(position.getColumn());
+      sourceMap.put<uint8_t>(position.getChecksum());
+      lastStart = start;
+      lastLine = line;
+    }
+
+    ByteBuffer stringPool;
+    strings.write(stringPool);
+
+    std::vector<std::pair<GCodeBytecodeSection, const ByteBuffer *>> sections {
+      { GCodeBytecodeSection::Strings, &stringPool },
+      { GCodeBytecodeSection::Code, &code },
+      { GCodeBytecodeSection::Symbols, &symbols },
+      { GCodeBytecodeSection::Labels, &labels },
+      { GCodeBytecodeSection::Procedures, &procedures },
+      { GCodeBytecodeSection::SourceMap, &sourceMap }
+    };
+    ByteBuffer table, payload;
+    std::size_t offset = sizeof(FileHeader) + sections.size() * sizeof(SectionHeader);
+    for (const auto &section : sections) {
+      payload.align(SectionAlignment);
+      SectionHeader header {};
+      header.type = static_cast<uint32_t>(section.first);
+      header.offset = offset + payload.getData().size();
+      header.length = section.second->getData().size();
+      table.put(header);
+      payload.putBytes(section.second->getData());
+    }
+
+    FileHeader header {};
+    std::memcpy(header.magic, GCodeBytecodeFormat::Magic, sizeof(header.magic));
+    header.version = GCodeBytecodeFormat::Version;
+    header.byteOrder = GCodeBytecodeFormat::ByteOrder;
+    header.sectionCount = static_cast<uint32_t>(sections.size());
+    header.checksum = checksum(payload.getData().data(), payload.getData().size());
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    os.write(table.getData().data(), table.getData().size());
+    os.write(payload.getData().data(), payload.getData().size());
+    if (!os) {
+      throw GCodeRuntimeError("Unable to write bytecode");
+    }
+  }
+
+  void GCodeBytecodeWriter::write(const GCodeIRModule &module, const std::string &path) {
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    if (!os) {
+      throw GCodeRuntimeError("Unable to open bytecode file '" + path + "'");
+    }
+    this->write(module, os);
+  }
+
+  std::unique_ptr<GCodeIRModule> GCodeBytecodeReader::read(const char *data, std::size_t length) {
+    if (length < sizeof(FileHeader)) {
+      throw GCodeRuntimeError("Malformed bytecode: truncated header");
+    }
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, GCodeBytecodeFormat::Magic, sizeof(header.magic)) != 0) {
+      throw GCodeRuntimeError("Malformed bytecode: invalid magic");
+    } else if (header.byteOrder != GCodeBytecodeFormat::ByteOrder) {
+      throw GCodeRuntimeError("Malformed bytecode: byte order mismatch");
+    } else if (header.version != GCodeBytecodeFormat::Version) {
+      throw GCodeRuntimeError("Unsupported bytecode version " + std::to_string(header.version));
+    }
+    std::size_t payloadOffset = sizeof(FileHeader) + static_cast<std::size_t>(header.sectionCount) * sizeof(SectionHeader);
+    if (header.sectionCount > (length - sizeof(FileHeader)) / sizeof(SectionHeader)) {
+      throw GCodeRuntimeError("Malformed bytecode: truncated section table");
+    } else if (checksum(data + payloadOffset, length - payloadOffset) != header.checksum) {
+      throw GCodeRuntimeError("Malformed bytecode: checksum mismatch");
+    }
+
+    std::map<GCodeBytecodeSection, ByteCursor> sections;
+    for (uint32_t i = 0; i < header.sectionCount; i++) {
+      SectionHeader section;
+      std::memcpy(&section, data + sizeof(FileHeader) + i * sizeof(SectionHeader), sizeof(section));
+      if (section.offset < payloadOffset || section.offset > length || section.length > length - section.offset) {
+        throw GCodeRuntimeError("Malformed bytecode: section out of bounds");
+      }
+      sections.emplace(static_cast<GCodeBytecodeSection>(section.type),
+        ByteCursor(data + section.offset, static_cast<std::size_t>(section.length)));
+    }
+    auto section = [&](GCodeBytecodeSection type) -> ByteCursor & {
+      auto it = sections.find(type);
+      if (it == sections.end()) {
+        throw GCodeRuntimeError("Malformed bytecode: missing section " + std::to_string(static_cast<uint32_t>(type)));
+      }
+      return it->second;
+    };
+
+    ByteCursor &stringPool = section(GCodeBytecodeSection::Strings);
+    std::vector<std::string> strings(stringPool.getCount(sizeof(uint32_t)));
+    for (auto &str : strings) {
+      uint32_t size = stringPool.get<uint32_t>();
+      str.assign(stringPool.take(size), size);
+    }
+
+    std::unique_ptr<GCodeIRModule> module = std::make_unique<GCodeIRModule>();
+    ByteCursor &code = section(GCodeBytecodeSection::Code);
+    if (code.remaining() % sizeof(CodeRecord) != 0) {
+      throw GCodeRuntimeError("Malformed bytecode: truncated code section");
+    }
+    std::size_t codeLength = code.remaining() / sizeof(CodeRecord);
+    module->code.reserve(codeLength);
+    for (std::size_t i = 0; i < codeLength; i++) {
+      CodeRecord record = code.get<CodeRecord>();
+      if (record.opcode > static_cast<uint8_t>(GCodeIROpcode::Not)) {
+        throw GCodeRuntimeError("Malformed bytecode: unknown opcode " + std::to_string(record.opcode));
+      }
+      GCodeIROpcode opcode = static_cast<GCodeIROpcode>(record.opcode);
+      switch (static_cast<OperandType>(record.type)) {
+        case OperandType::None:
+          module->code.push_back(GCodeIRInstruction(opcode));
+          break;
+        case OperandType::Integer:
+          module->code.push_back(GCodeIRInstruction(opcode, static_cast<int64_t>(record.operand)));
+          break;
+        case OperandType::Float: {
+          double real;
+          std::memcpy(&real, &record.operand, sizeof(double));
+          module->code.push_back(GCodeIRInstruction(opcode, real));
+        } break;
+        case OperandType::String:
+          module->code.push_back(GCodeIRInstruction(opcode, string_at(strings, record.operand)));
+          break;
+        default:
+          throw GCodeRuntimeError("Malformed bytecode: unknown operand type " + std::to_string(record.type));
+      }
+    }
+
+    ByteCursor &symbols = section(GCodeBytecodeSection::Symbols);
+    for (std::size_t count = symbols.getCount(sizeof(uint64_t) + sizeof(uint32_t)); count > 0; count--) {
+      std::size_t id = static_cast<std::size_t>(symbols.get<uint64_t>());
+      const std::string &symbol = string_at(strings, symbols.get<uint32_t>());
+      module->symbols[id] = symbol;
+      module->symbolIdentifiers[symbol] = id;
+    }
+
+    ByteCursor &labels = section(GCodeBytecodeSection::Labels);
+    for (std::size_t count = labels.getCount(sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint64_t)); count > 0; count--) {
+      const std::string &name = string_at(strings, labels.get<uint32_t>());
+      uint8_t bound = labels.get<uint8_t>();
+      uint64_t address = labels.get<uint64_t>();
+      auto label = std::make_shared<GCodeIRLabel>(*module);
+      if (bound != 0) {
+        if (address > codeLength) {
+          throw GCodeRuntimeError("Malformed bytecode: label address out of range");
+        }
+        label->address = static_cast<std::size_t>(address);
+      }
+      module->labels[name] = label;
+    }
+
+    ByteCursor &procedures = section(GCodeBytecodeSection::Procedures);
+    for (std::size_t count = procedures.getCount(sizeof(int64_t) + sizeof(uint32_t)); count > 0; count--) {
+      int64_t id = procedures.get<int64_t>();
+      const std::string &name = string_at(strings, procedures.get<uint32_t>());
+      auto label = module->labels.find(name);
+      if (label == module->labels.end()) {
+        throw GCodeRuntimeError("Malformed bytecode: unknown procedure label '" + name + "'");
+      }
+      module->procedures[id] = label->second;
+    }
+
+    ByteCursor &sourceMap = section(GCodeBytecodeSection::SourceMap);
+    int64_t start = 0;
+    int64_t line = 0;
+    // Each block takes at least five single-byte varints and the checksum byte
+    uint64_t blocks = sourceMap.getVarint();
+    if (blocks > sourceMap.remaining() / 6) {
+      throw GCodeRuntimeError("Malformed bytecode: record count exceeds section length");
+    }
+    for (uint64_t count = blocks; count > 0; count--) {
+      start += unzigzag(sourceMap.getVarint());
+      std::size_t blockLength = static_cast<std::size_t>(sourceMap.getVarint());
+      const std::string &tag = string_at(strings, sourceMap.getVarint());
+      line += unzigzag(sourceMap.getVarint());
+      uint16_t column = static_cast<uint16_t>(sourceMap.getVarint());
+      uint8_t checksum = sourceMap.get<uint8_t>();
+      module->sourceMap.addBlock(Parser::SourcePosition(tag, static_cast<uint32_t>(line), column, checksum),
+        static_cast<std::size_t>(start), blockLength);
+    }
+
+    if (module->linked()) {
+      module->freeze();
+    }
+    return module;
+  }
+
+  std::unique_ptr<GCodeIRModule> GCodeBytecodeReader::load(const std::string &path, std::size_t offset) {
+    std::ifstream is(path, std::ios::binary);
+    if (!is) {
+      throw GCodeRuntimeError("Unable to open bytecode file '" + path + "'");
+    }
+    std::stringstream ss;
+    ss << is.rdbuf();
+    std::string image = ss.str();
+    if (offset > image.size()) {
+      throw GCodeRuntimeError("Malformed bytecode: offset is out of file bounds");
+    }
+    return this->read(image.data() + offset, image.size() - offset);
+  }
+}
\ No newline at end of file
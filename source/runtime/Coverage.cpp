@@ -0,0 +1,208 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+#include "gcodelib/runtime/Coverage.h"
+#include "gcodelib/runtime/Error.h"
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <istream>
+#include <map>
+#include <ostream>
+
+namespace GCodeLib::Runtime {
+
+  static constexpr uint16_t ByteOrder = 0x0102;
+  static constexpr std::size_t WordBits = 64;
+  static constexpr std::size_t ChunkWords = 4096;
+
+  GCodeCoverageBitmap::GCodeCoverageBitmap(std::size_t bits)
+    : bits(bits), words((bits + WordBits - 1) / WordBits, 0) {}
+
+  std::size_t GCodeCoverageBitmap::size() const {
+    return this->bits;
+  }
+
+  bool GCodeCoverageBitmap::test(std::size_t address) const {
+    return address < this->bits && (this->words[address / WordBits] >> (address % WordBits)) & 1;
+  }
+
+  std::size_t GCodeCoverageBitmap::count() const {
+    std::size_t count = 0;
+    for (uint64_t word : this->words) {
+      count += std::bitset<WordBits>(word).count();
+    }
+    return count;
+  }
+
+  void GCodeCoverageBitmap::clear() {
+    std::fill(this->words.begin(), this->words.end(), 0);
+  }
+
+  void GCodeCoverageBitmap::write(std::ostream &os) const {
+    uint64_t bits = this->bits;
+    os.write(GCodeCoverageBitmap::Magic, sizeof(GCodeCoverageBitmap::Magic));
+    os.write(reinterpret_cast<const char *>(&GCodeCoverageBitmap::Version), sizeof(GCodeCoverageBitmap::Version));
+    os.write(reinterpret_cast<const char *>(&ByteOrder), sizeof(ByteOrder));
+    os.write(reinterpret_cast<const char *>(&bits), sizeof(bits));
+    os.write(reinterpret_cast<const char *>(this->words.data()), this->words.size() * sizeof(uint64_t));
+    if (!os) {
+      throw GCodeRuntimeError("Unable to write coverage bitmap");
+    }
+  }
+
+  GCodeCoverageBitmap GCodeCoverageBitmap::read(std::istream &is, std::size_t instructions) {
+    char magic[sizeof(GCodeCoverageBitmap::Magic)];
+    uint16_t version = 0;
+    uint16_t byteOrder = 0;
+    uint64_t bits = 0;
+    is.read(magic, sizeof(magic));
+    is.read(reinterpret_cast<char *>(&version), sizeof(version));
+    is.read(reinterpret_cast<char *>(&byteOrder), sizeof(byteOrder));
+    is.read(reinterpret_cast<char *>(&bits), sizeof(bits));
+    if (!is || std::memcmp(magic, GCodeCoverageBitmap::Magic, sizeof(magic)) != 0) {
+      throw GCodeRuntimeError("Malformed coverage bitmap: bad header");
+    }
+    if (version != GCodeCoverageBitmap::Version) {
+      throw GCodeRuntimeError("Unsupported coverage bitmap version");
+    }
+    if (byteOrder != ByteOrder) {
+      throw GCodeRuntimeError("Coverage bitmap byte order does not match the host");
+    }
+    if (instructions != GCodeCoverageBitmap::AnySize && bits != instructions) {
+      throw GCodeRuntimeError("Coverage bitmap does not match the module");
+    }
+    // The bit count is untrusted: compare it with what the stream holds, when that is known, and grow
+    // the words as they are read otherwise
+    uint64_t words = bits / WordBits + (bits % WordBits != 0 ? 1 : 0);
+    std::istream::pos_type position = is.tellg();
+    if (position != std::istream::pos_type(-1)) {
+      is.seekg(0, std::ios::end);
+      std::istream::pos_type end = is.tellg();
+      is.seekg(position);
+      if (!is || end == std::istream::pos_type(-1) || static_cast<uint64_t>(end - position) / sizeof(uint64_t) < words) {
+        throw GCodeRuntimeError("Malformed coverage bitmap: truncated");
+      }
+    }
+    GCodeCoverageBitmap bitmap;
+    while (bitmap.words.size() < words) {
+      std::size_t offset = bitmap.words.size();
+      bitmap.words.resize(offset + static_cast<std::size_t>(std::min<uint64_t>(words - offset, ChunkWords)));
+      is.read(reinterpret_cast<char *>(bitmap.words.data() + offset), (bitmap.words.size() - offset) * sizeof(uint64_t));
+      if (!is) {
+        throw GCodeRuntimeError("Malformed coverage bitmap: truncated");
+      }
+    }
+    bitmap.bits = static_cast<std::size_t>(bits);
+    return bitmap;
+  }
+
+  GCodeCoverageBitmap &GCodeCoverageBitmap::operator|=(const GCodeCoverageBitmap &other) {
+    if (other.bits != this->bits) {
+      throw GCodeRuntimeError("Coverage bitmaps of different modules can not be merged");
+    }
+    for (std::size_t i = 0; i < this->words.size(); i++) {
+      this->words[i] |= other.words[i];
+    }
+    return *this;
+  }
+
+  bool GCodeCoverageBitmap::operator==(const GCodeCoverageBitmap &other) const {
+    return this->bits == other.bits && this->words == other.words;
+  }
+
+  bool GCodeCoverageBitmap::operator!=(const GCodeCoverageBitmap &other) const {
+    return !(*this == other);
+  }
+
+  GCodeCoverage::GCodeCoverage(const GCodeIRModule &module)
+    : module(module), bitmap(module.length()) {}
+
+  const GCodeIRModule &GCodeCoverage::getModule() const {
+    return this->module;
+  }
+
+  const GCodeCoverageBitmap &GCodeCoverage::getBitmap() const {
+    return this->bitmap;
+  }
+
+  void GCodeCoverage::merge(const GCodeCoverageBitmap &bitmap) {
+    this->bitmap |= bitmap;
+  }
+
+  void GCodeCoverage::reset() {
+    this->bitmap.clear();
+  }
+
+  std::vector<GCodeCoverageLine> GCodeCoverage::getLines() const {
+    return GCodeCoverage::getLines(this->module, this->bitmap);
+  }
+
+  void GCodeCoverage::writeLcov(std::ostream &os) const {
+    GCodeCoverage::writeLcov(os, this->module, this->bitmap);
+  }
+
+  std::vector<GCodeCoverageLine> GCodeCoverage::getLines(const GCodeIRModule &module, const GCodeCoverageBitmap &bitmap) {
+    if (bitmap.size() != module.length()) {
+      throw GCodeRuntimeError("Coverage bitmap does not match the module");
+    }
+    std::map<std::pair<std::string, uint32_t>, std::pair<std::size_t, std::size_t>> counters;
+    const IRSourceMap &sourceMap = module.getSourceMap();
+    // A procedure definition opens with a jump over its body. Taking it does not run the procedure,
+    // so it is not attributed to the definition line
+    std::vector<bool> skipped(module.length(), false);
+    for (std::size_t index = 0; index < sourceMap.size(); index++) {
+      IRSourceBlock block = sourceMap.getBlock(index);
+      if (block.getLength() > 0) {
+        const GCodeIRInstruction &instr = module.at(block.getStartAddress());
+        skipped[block.getStartAddress()] = skipped[block.getStartAddress()] || (instr.getOpcode() == GCodeIROpcode::Jump &&
+          static_cast<std::size_t>(instr.getValue().getInteger(-1)) == block.getStartAddress() + block.getLength());
+      }
+    }
+    for (std::size_t address = 0; address < module.length(); address++) {
+      // Source blocks nest, so each address belongs only to the innermost block covering it
+      std::optional<Parser::SourcePosition> position = sourceMap.locate(address);
+      if (position.has_value() && !skipped[address]) {
+        auto &counter = counters[std::make_pair(position->getTag(), position->getLine())];
+        counter.first++;
+        if (bitmap.test(address)) {
+          counter.second++;
+        }
+      }
+    }
+    std::vector<GCodeCoverageLine> lines;
+    for (const auto &entry : counters) {
+      lines.push_back(GCodeCoverageLine { entry.first.first, entry.first.second, entry.second.first, entry.second.second });
+    }
+    return lines;
+  }
+
+  void GCodeCoverage::writeLcov(std::ostream &os, const GCodeIRModule &module, const GCodeCoverageBitmap &bitmap) {
+    auto lines = GCodeCoverage::getLines(module, bitmap);
+    std::size_t found = 0;
+    std::size_t hit = 0;
+    for (std::size_t index = 0; index < lines.size(); index++) {
+      const GCodeCoverageLine &line = lines[index];
+      if (index == 0 || line.tag != lines[index - 1].tag) {
+        os << "SF:" << line.tag << std::endl;
+        found = 0;
+        hit = 0;
+      }
+      os << "DA:" << line.line << ',' << (line.covered > 0 ? 1 : 0) << std::endl;
+      found++;
+      hit += line.covered > 0 ? 1 : 0;
+      if (index + 1 == lines.size() || line.tag != lines[index + 1].tag) {
+        os << "LF:" << found << std::endl << "LH:" << hit << std::endl << "end_of_record" << std::endl;
+      }
+    }
+  }
+}
\ No newline at end of file
@@ -112,6 +112,7 @@ namespace GCodeLib::Runtime {
     : module(module) {}
 
   void GCodeIRLabel::bind() {
+    this->module.assertMutable();
     if (!this->address.has_value()) {
       this->address = module.code.size();
       for (std::size_t addr : this->patched) {
@@ -128,6 +129,7 @@ namespace GCodeLib::Runtime {
   }
 
   void GCodeIRLabel::jump() {
+    this->module.assertMutable();
     if (this->address.has_value()) {
       this->module.appendInstruction(GCodeIROpcode::Jump, static_cast<int64_t>(this->address.value()));
     } else {
@@ -138,6 +140,7 @@ namespace GCodeLib::Runtime {
   }
 
   void GCodeIRLabel::jumpIf() {
+    this->module.assertMutable();
     if (this->address.has_value()) {
       this->module.appendInstruction(GCodeIROpcode::JumpIf, static_cast<int64_t>(this->address.value()));
     } else {
@@ -168,10 +171,11 @@ namespace GCodeLib::Runtime {
   }
 
   std::unique_ptr<GCodeIRPosition> GCodeIRModule::newPositionRegister(const Parser::SourcePosition &position) {
+    this->assertMutable();
     return std::make_unique<GCodeIRPosition>(*this, position);
   }
 
-  IRSourceMap &GCodeIRModule::getSourceMap() {
+  const IRSourceMap &GCodeIRModule::getSourceMap() const {
     return this->sourceMap;
   }
 
@@ -179,6 +183,7 @@ namespace GCodeLib::Runtime {
     if (this->symbolIdentifiers.count(symbol) != 0) {
       return this->symbolIdentifiers.at(symbol);
     } else {
+      this->assertMutable();
       std::size_t symbolId = this->symbols.size();
       this->symbols[symbolId] = symbol;
       this->symbolIdentifiers[symbol] = symbolId;
@@ -197,12 +202,14 @@ namespace GCodeLib::Runtime {
 
   GCodeIRLabel &GCodeIRModule::getNamedLabel(const std::string &label) {
     if (this->labels.count(label) == 0) {
+      this->assertMutable();
       this->labels[label] = std::make_shared<GCodeIRLabel>(*this);
     }
     return *this->labels[label];
   }
 
   void GCodeIRModule::registerProcedure(int64_t procId, const std::string &label) {
+    this->assertMutable();
     if (this->labels.count(label) != 0) {
       this->procedures[procId] = this->labels[label];
     } else {
@@ -210,7 +217,7 @@ namespace GCodeLib::Runtime {
     }
   }
 
-  GCodeIRLabel &GCodeIRModule::getProcedure(int64_t procId) const {
+  const GCodeIRLabel &GCodeIRModule::getProcedure(int64_t procId) const {
     if (this->procedures.count(procId)) {
       return *this->procedures.at(procId);
     } else {
@@ -227,11 +234,41 @@ namespace GCodeLib::Runtime {
     return true;
   }
 
+  void GCodeIRModule::freeze() {
+    if (!this->linked()) {
+      throw GCodeRuntimeError("Module contains unbound labels");
+    }
+    this->frozen = true;
+  }
+
+  bool GCodeIRModule::isFrozen() const {
+    return this->frozen;
+  }
+
+  std::size_t GCodeIRModule::getFootprint() const {
+    std::size_t footprint = sizeof(GCodeIRModule) + this->code.capacity() * sizeof(GCodeIRInstruction);
+    for (const auto &kv : this->symbols) {
+      footprint += 2 * (sizeof(std::size_t) + sizeof(std::string) + kv.second.capacity());
+    }
+    footprint += this->labels.size() * (sizeof(std::string) + sizeof(GCodeIRLabel) + sizeof(std::shared_ptr<GCodeIRLabel>));
+    footprint += this->procedures.size() * (sizeof(int64_t) + sizeof(std::shared_ptr<GCodeIRLabel>));
+    footprint += this->sourceMap.getFootprint();
+    return footprint;
+  }
+
+  void GCodeIRModule::assertMutable() const {
+    if (this->frozen) {
+      throw GCodeRuntimeError("Module is frozen");
+    }
+  }
+
   void GCodeIRModule::appendInstruction(GCodeIROpcode opcode, const GCodeRuntimeValue &value) {
+    this->assertMutable();
     this->code.push_back(GCodeIRInstruction(opcode, value));
   }
 
   std::unique_ptr<GCodeIRLabel> GCodeIRModule::newLabel() {
+    this->assertMutable();
     return std::make_unique<GCodeIRLabel>(*this);
   }
 
@@ -264,6 +301,6 @@ namespace GCodeLib::Runtime {
     : module(module), position(position), start_address(module.length()) {}
   
   GCodeIRPosition::~GCodeIRPosition() {
-    module.getSourceMap().addBlock(this->position, this->start_address, this->module.length() - this->start_address);
+    module.sourceMap.addBlock(this->position, this->start_address, this->module.length() - this->start_address);
   }
 }
\ No newline at end of file
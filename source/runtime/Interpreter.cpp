@@ -48,8 +48,9 @@ namespace GCodeLib::Runtime {
     });
   }
 
-  GCodeInterpreter::GCodeInterpreter(GCodeIRModule &module)
-    : module(module) {
+  GCodeInterpreter::GCodeInterpreter(const GCodeIRModule &module)
+    : module(module), batch(nullptr), batchCapacity(0), batchLength(0), scopeAccess(GCodeSystemScopeAccess::Synchronized), scopeStall(false), budget(0), yieldOnSyscall(false),
+      stopAddress(GCodeInterpreter::Unbounded), trackedArguments(0), skipped(nullptr) {
     bind_default_functions(this->functions);
   }
   
@@ -60,12 +61,385 @@ namespace GCodeLib::Runtime {
     this->state.reset();
   }
 
+  void GCodeInterpreter::start() {
+    this->state = GCodeRuntimeState(this->getSystemScope(), this->config);
+    this->batchError = nullptr;
+    this->error.reset();
+  }
+
+  GCodeExecutionStatus GCodeInterpreter::runFor(std::size_t instructions) {
+    return this->resume(instructions, false);
+  }
+
+  GCodeExecutionStatus GCodeInterpreter::runUntilSyscall(std::size_t instructions) {
+    return this->resume(instructions, true);
+  }
+
+  const std::optional<GCodeRuntimeError> &GCodeInterpreter::getError() const {
+    return this->error;
+  }
+
+  GCodeExecutionStatus GCodeInterpreter::resume(std::size_t instructions, bool untilSyscall) {
+    if (!this->state.has_value()) {
+      throw GCodeRuntimeError("Execution state is not defined");
+    } else if (this->error.has_value()) {
+      return GCodeExecutionStatus::Error;
+    }
+    this->budget = instructions;
+    this->yieldOnSyscall = untilSyscall;
+    try {
+      this->run();
+    } catch (const GCodeRuntimeError &ex) {
+      this->yieldOnSyscall = false;
+      this->error = ex;
+      return GCodeExecutionStatus::Error;
+    }
+    this->yieldOnSyscall = false;
+    return this->isFinished() ? GCodeExecutionStatus::Finished : GCodeExecutionStatus::Yielded;
+  }
+
+  GCodeCommandSpan GCodeInterpreter::executeBatch(GCodeCommandRecord *buffer, std::size_t capacity, std::size_t instructions, GCodeSystemScopeAccess access) {
+    if (this->batchError) {
+      std::exception_ptr error = this->batchError;
+      this->batchError = nullptr;
+      std::rethrow_exception(error);
+    }
+    if (capacity == 0) {
+      throw GCodeRuntimeError("Command buffer is empty");
+    }
+    this->batch = buffer;
+    this->batchCapacity = capacity;
+    this->batchLength = 0;
+    this->scopeAccess = access;
+    this->scopeStall = false;
+    this->budget = instructions;
+    try {
+      this->run();
+    } catch (...) {
+      this->batch = nullptr;
+      this->scopeAccess = GCodeSystemScopeAccess::Synchronized;
+      if (this->batchLength == 0) {
+        throw;
+      }
+      this->batchError = std::current_exception();
+    }
+    this->batch = nullptr;
+    this->scopeAccess = GCodeSystemScopeAccess::Synchronized;
+    return GCodeCommandSpan(buffer, this->batchLength);
+  }
+
+  GCodeFastForwardSummary GCodeInterpreter::fastForward(uint32_t line, const std::string &tracked) {
+    std::optional<std::size_t> address = this->module.getSourceMap().findAddress(line);
+    if (!address.has_value()) {
+      throw GCodeRuntimeError("Line " + std::to_string(line) + " is not mapped to any instruction");
+    }
+    return this->seek(address.value(), tracked);
+  }
+
+  GCodeFastForwardSummary GCodeInterpreter::fastForward(const std::string &tag, uint32_t line, const std::string &tracked) {
+    std::optional<std::size_t> address = this->module.getSourceMap().findAddress(tag, line);
+    if (!address.has_value()) {
+      throw GCodeRuntimeError("Line " + tag + ":" + std::to_string(line) + " is not mapped to any instruction");
+    }
+    return this->seek(address.value(), tracked);
+  }
+
+  GCodeFastForwardSummary GCodeInterpreter::seek(std::size_t address, const std::string &tracked) {
+    if (!this->state.has_value()) {
+      throw GCodeRuntimeError("Execution state is not defined");
+    }
+    GCodeFastForwardSummary summary;
+    summary.address = address;
+    this->trackedArguments = 0;
+    for (unsigned char key : tracked) {
+      this->trackedArguments |= GCodeSyscallArguments::bit(key);
+    }
+    this->skipped = &summary;
+    this->stopAddress = address;
+    this->budget = GCodeInterpreter::Unbounded;
+    try {
+      this->run();
+    } catch (...) {
+      this->skipped = nullptr;
+      this->stopAddress = GCodeInterpreter::Unbounded;
+      throw;
+    }
+    summary.instructions = GCodeInterpreter::Unbounded - this->budget;
+    summary.reached = this->state.has_value() && this->state.value().getPC() == address;
+    this->skipped = nullptr;
+    this->stopAddress = GCodeInterpreter::Unbounded;
+    return summary;
+  }
+
+  void GCodeInterpreter::skipSyscall(GCodeSyscallType type, const GCodeRuntimeValue &function, const GCodeSyscallArguments &args) {
+    this->skipped->syscalls++;
+    this->skipped->functions[type] = function.asFloat();
+    uint32_t tracked = args.getMask() & this->trackedArguments;
+    for (unsigned char key = 'A'; tracked != 0; key++, tracked >>= 1) {
+      if (tracked & 1) {
+        this->skipped->modal.put(key, args.getValue(key));
+      }
+    }
+  }
+
+  GCodeRuntimeSnapshot GCodeInterpreter::snapshot() const {
+    if (!this->state.has_value()) {
+      throw GCodeRuntimeError("Execution state is not defined");
+    }
+    return this->state.value().snapshot();
+  }
+
+  void GCodeInterpreter::restore(const GCodeRuntimeSnapshot &snapshot) {
+    if (snapshot.pc > this->module.length()) {
+      throw GCodeRuntimeError("Snapshot does not belong to the module");
+    }
+    if (!this->state.has_value()) {
+      this->start();
+    }
+    this->state.value().restore(snapshot);
+    this->batchError = nullptr;
+    this->error.reset();
+  }
+
+  void GCodeInterpreter::fork(GCodeInterpreter &branch) const {
+    if (!this->state.has_value()) {
+      throw GCodeRuntimeError("Execution state is not defined");
+    } else if (&branch.module != &this->module) {
+      throw GCodeRuntimeError("Forked interpreter must share the module");
+    } else if (this->error.has_value() || this->batchError) {
+      throw GCodeRuntimeError("Unable to fork a failed interpreter");
+    }
+    branch.state = this->state.value().fork(branch.getSystemScope(), branch.config);
+    branch.batchError = nullptr;
+    branch.error.reset();
+  }
+
+  std::vector<GCodeRuntimeSnapshot> GCodeInterpreter::checkpoint(std::size_t interval) {
+    if (interval == 0) {
+      throw GCodeRuntimeError("Checkpoint interval must be positive");
+    }
+    this->start();
+    std::vector<GCodeRuntimeSnapshot> checkpoints;
+    checkpoints.push_back(this->state.value().snapshot());
+    GCodeFastForwardSummary summary;
+    this->skipped = &summary;
+    this->yieldOnSyscall = true;
+    try {
+      while (!this->isFinished()) {
+        std::size_t commands = summary.syscalls;
+        this->budget = GCodeInterpreter::Unbounded;
+        this->run();
+        if (summary.syscalls != commands && summary.syscalls % interval == 0 && !this->isFinished()) {
+          checkpoints.push_back(this->state.value().snapshot(&checkpoints.back()));
+          checkpoints.back().commands = summary.syscalls;
+        }
+      }
+    } catch (...) {
+      this->skipped = nullptr;
+      this->yieldOnSyscall = false;
+      throw;
+    }
+    this->skipped = nullptr;
+    this->yieldOnSyscall = false;
+    return checkpoints;
+  }
+
+  bool GCodeInterpreter::isFinished() const {
+    return !this->batchError &&
+      (!this->state.has_value() || this->state.value().getPC() >= this->module.length());
+  }
+
+  // The last batch stopped before a variable access that needs the host's pending commands applied
+  bool GCodeInterpreter::isWaitingForSystemScope() const {
+    return this->scopeStall;
+  }
+
+  bool GCodeInterpreter::readsSystemScope(const GCodeIRInstruction &instr) {
+    bool unsynchronized = this->scopeAccess == GCodeSystemScopeAccess::Unsynchronized;
+    switch (instr.getOpcode()) {
+      case GCodeIROpcode::LoadNumbered:
+        return unsynchronized || this->getSystemScope().getNumbered().has(instr.getValue().getInteger());
+      case GCodeIROpcode::LoadNamed:
+        return unsynchronized || this->getSystemScope().getNamed().has(this->module.getSymbol(static_cast<std::size_t>(instr.getValue().getInteger())));
+      case GCodeIROpcode::StoreNumbered:
+      case GCodeIROpcode::StoreNamed:
+        // Cascading stores look the key up in the system scope as well
+        return unsynchronized;
+      default:
+        return false;
+    }
+  }
+
   void GCodeInterpreter::interpret() {
+    this->budget = GCodeInterpreter::Unbounded;
+    this->run();
+  }
+
+  void GCodeInterpreter::setProfiler(GCodeProfiler *profiler) {
+    if (profiler != nullptr && &profiler->getModule() != &this->module) {
+      throw GCodeRuntimeError("Profiler is bound to another module");
+    }
+    this->attach(profiler);
+  }
+
+  GCodeProfiler *GCodeInterpreter::getProfiler() const {
+    return std::get<GCodeProfiler *>(this->tracers);
+  }
+
+  void GCodeInterpreter::setTelemetry(GCodeTelemetry *telemetry) {
+    if (telemetry != nullptr && &telemetry->getModule() != &this->module) {
+      throw GCodeRuntimeError("Telemetry is bound to another module");
+    }
+    this->attach(telemetry);
+  }
+
+  GCodeTelemetry *GCodeInterpreter::getTelemetry() const {
+    return std::get<GCodeTelemetry *>(this->tracers);
+  }
+
+  void GCodeInterpreter::setTimeline(GCodeTimelineTracer *timeline) {
+    if (timeline != nullptr && &timeline->getModule() != &this->module) {
+      throw GCodeRuntimeError("Timeline is bound to another module");
+    }
+    this->attach(timeline);
+  }
+
+  GCodeTimelineTracer *GCodeInterpreter::getTimeline() const {
+    return std::get<GCodeTimelineTracer *>(this->tracers);
+  }
+
+  void GCodeInterpreter::setCoverage(GCodeCoverage *coverage) {
+    if (coverage != nullptr && &coverage->getModule() != &this->module) {
+      throw GCodeRuntimeError("Coverage is bound to another module");
+    }
+    this->attach(coverage);
+  }
+
+  GCodeCoverage *GCodeInterpreter::getCoverage() const {
+    return std::get<GCodeCoverage *>(this->tracers);
+  }
+
+  void GCodeInterpreter::setTracer(std::nullptr_t) {
+    this->attachEvents<GCodeTracer>(nullptr);
+  }
+
+  void GCodeInterpreter::setTracer(GCodeTracer *tracer) {
+    this->attachEvents(tracer);
+  }
+
+  void GCodeInterpreter::setTracer(GCodeRingBufferTracer *tracer) {
+    this->attachEvents(tracer);
+  }
+
+  void GCodeInterpreter::setTracer(GCodeFileTracer *tracer) {
+    this->attachEvents(tracer);
+  }
+
+  class GCodeInterpreter::CompositeTracer {
+   public:
+    CompositeTracer(const TracerSet &tracers)
+      : tracers(tracers) {}
+
+    void resume() {
+      std::apply([](auto *... tracer) {
+        (..., (tracer != nullptr ? tracer->resume() : void()));
+      }, this->tracers);
+    }
+
+    void suspend() {
+      std::apply([](auto *... tracer) {
+        (..., (tracer != nullptr ? tracer->suspend() : void()));
+      }, this->tracers);
+    }
+
+    void instruction(std::size_t address, const GCodeIRInstruction &instr) {
+      std::apply([&](auto *... tracer) {
+        (..., (tracer != nullptr ? tracer->instruction(address, instr) : void()));
+      }, this->tracers);
+    }
+
+    void syscall(std::size_t address, GCodeSyscallType type, const GCodeRuntimeValue &function, const GCodeSyscallArguments &args) {
+      std::apply([&](auto *... tracer) {
+        (..., (tracer != nullptr ? tracer->syscall(address, type, function, args) : void()));
+      }, this->tracers);
+    }
+
+    void call(std::size_t address, int64_t procedure, std::size_t target) {
+      std::apply([&](auto *... tracer) {
+        (..., (tracer != nullptr ? tracer->call(address, procedure, target) : void()));
+      }, this->tracers);
+    }
+
+    void ret(std::size_t address, std::size_t target) {
+      std::apply([&](auto *... tracer) {
+        (..., (tracer != nullptr ? tracer->ret(address, target) : void()));
+      }, this->tracers);
+    }
+
+    void storeNumbered(std::size_t address, int64_t key, const GCodeRuntimeValue &value) {
+      std::apply([&](auto *... tracer) {
+        (..., (tracer != nullptr ? tracer->storeNumbered(address, key, value) : void()));
+      }, this->tracers);
+    }
+
+    void storeNamed(std::size_t address, std::size_t symbol, const GCodeRuntimeValue &value) {
+      std::apply([&](auto *... tracer) {
+        (..., (tracer != nullptr ? tracer->storeNamed(address, symbol, value) : void()));
+      }, this->tracers);
+    }
+   private:
+    const TracerSet &tracers;
+  };
+
+  void GCodeInterpreter::run() {
+    std::size_t attached = std::apply([](auto *... tracer) {
+      return (std::size_t{0} + ... + (tracer != nullptr ? 1 : 0));
+    }, this->tracers);
+    if (attached == 0) {
+      GCodeNullTracer none;
+      this->loop(none);
+    } else if (attached == 1) {
+      std::apply([this](auto *... tracer) {
+        (..., (tracer != nullptr ? this->trace(*tracer) : void()));
+      }, this->tracers);
+    } else {
+      CompositeTracer composite(this->tracers);
+      this->trace(composite);
+    }
+  }
+
+  template <typename Tracer>
+  void GCodeInterpreter::trace(Tracer &tracer) {
+    tracer.resume();
+    try {
+      this->loop(tracer);
+    } catch (...) {
+      // The original error wins over a tracer that fails to flush on the way out
+      try {
+        tracer.suspend();
+      } catch (...) {}
+      throw;
+    }
+    tracer.suspend();
+  }
+
+  template <typename Tracer>
+  void GCodeInterpreter::loop(Tracer &tracer) {
     GCodeRuntimeState &frame = this->getState();
-    GCodeScopedDictionary<unsigned char> args;
-    while (this->state.has_value() && frame.getPC() < this->module.length()) {
+    GCodeSyscallArguments &args = frame.getSyscallArguments();
+    while (this->budget != 0 && this->state.has_value() && frame.getPC() < this->module.length()) {
       std::size_t current_address = frame.getPC();
-      const GCodeIRInstruction &instr = this->module.at(frame.nextPC());
+      if (current_address == this->stopAddress) {
+        break;
+      }
+      const GCodeIRInstruction &instr = this->module.at(current_address);
+      if ((this->batchLength > 0 || this->scopeAccess == GCodeSystemScopeAccess::Unsynchronized) && this->batch != nullptr && this->readsSystemScope(instr)) {
+        this->scopeStall = true;
+        break;
+      }
+      frame.nextPC();
+      this->budget--;
+      tracer.instruction(current_address, instr);
       try {
         switch (instr.getOpcode()) {
           case GCodeIROpcode::Push:
@@ -76,12 +450,32 @@ namespace GCodeLib::Runtime {
             break;
           case GCodeIROpcode::SetArg: {
             unsigned char key = static_cast<unsigned char>(instr.getValue().assertNumeric().asInteger());
-            args.put(key, frame.pop());
+            if (!args.put(key, frame.pop())) {
+              throw GCodeRuntimeError("Invalid syscall argument \'" + std::string(1, key) + "\'");
+            }
           } break;
           case GCodeIROpcode::Syscall: {
             GCodeSyscallType type = static_cast<GCodeSyscallType>(instr.getValue().assertNumeric().asInteger());
             GCodeRuntimeValue function = frame.pop();
-            this->syscall(type, function, args);
+            tracer.syscall(current_address, type, function, args);
+            if (this->skipped != nullptr) {
+              this->skipSyscall(type, function, args);
+            } else if (this->batch != nullptr) {
+              GCodeCommandRecord &record = this->batch[this->batchLength++];
+              record.type = type;
+              record.function = function.asFloat();
+              record.mask = args.getMask();
+              record.address = current_address;
+              record.values = args.getValues();
+              if (this->batchLength == this->batchCapacity) {
+                this->budget = 0;
+              }
+            } else {
+              this->syscall(type, function, args);
+            }
+            if (this->yieldOnSyscall) {
+              this->budget = 0;
+            }
           } break;
           case GCodeIROpcode::Jump: {
             std::size_t pc = static_cast<std::size_t>(instr.getValue().assertNumeric().asInteger());
@@ -97,6 +491,7 @@ namespace GCodeLib::Runtime {
           case GCodeIROpcode::Call: {
             int64_t pid = frame.pop().assertNumeric().asInteger();
             frame.call(this->module.getProcedure(pid).getAddress());
+            tracer.call(current_address, pid, frame.getPC());
             std::size_t argc = static_cast<std::size_t>(instr.getValue().assertNumeric().getInteger());
             while (argc-- > 0) {
               frame.getScope().getNumbered().put(argc, frame.pop());
@@ -104,6 +499,7 @@ namespace GCodeLib::Runtime {
           } break;
           case GCodeIROpcode::Ret: {
             frame.ret();
+            tracer.ret(current_address, frame.getPC());
             std::size_t argc = static_cast<std::size_t>(instr.getValue().assertNumeric().getInteger());
             while (argc-- > 0) {
               frame.getScope().getNumbered().put(argc, frame.pop());
@@ -155,11 +551,11 @@ namespace GCodeLib::Runtime {
           case GCodeIROpcode::Invoke: {
             const std::string &functionId = this->module.getSymbol(instr.getValue().assertNumeric().getInteger());
             std::size_t argc = frame.pop().assertNumeric().asInteger();
-            std::vector<GCodeRuntimeValue> args;
+            this->invokeArgs.clear();
             while (argc--) {
-              args.push_back(frame.pop());
+              this->invokeArgs.push_back(frame.pop());
             }
-            frame.push(this->functions.invoke(functionId, args));
+            frame.push(this->functions.invoke(functionId, this->invokeArgs));
           } break;
           case GCodeIROpcode::LoadNumbered: {
             const GCodeRuntimeValue &value = frame.getScope().getNumbered().get(instr.getValue().assertNumeric().getInteger());
@@ -172,12 +568,15 @@ namespace GCodeLib::Runtime {
           } break;
           case GCodeIROpcode::StoreNumbered: {
             GCodeRuntimeValue value = frame.pop();
-            frame.getScope().getNumbered().put(instr.getValue().assertNumeric().getInteger(), value);
+            int64_t key = instr.getValue().assertNumeric().getInteger();
+            tracer.storeNumbered(current_address, key, value);
+            frame.getScope().getNumbered().put(key, value);
           } break;
           case GCodeIROpcode::StoreNamed: {
             GCodeRuntimeValue value = frame.pop();
-            const std::string &symbol = this->module.getSymbol(static_cast<std::size_t>(instr.getValue().assertNumeric().getInteger()));
-            frame.getScope().getNamed().put(symbol, value);
+            std::size_t symbolId = static_cast<std::size_t>(instr.getValue().assertNumeric().getInteger());
+            tracer.storeNamed(current_address, symbolId, value);
+            frame.getScope().getNamed().put(this->module.getSymbol(symbolId), value);
           } break;
         }
       } catch (GCodeRuntimeError &ex) {
@@ -192,6 +591,12 @@ namespace GCodeLib::Runtime {
     }
   }
 
+  void GCodeInterpreter::syscall(GCodeSyscallType type, const GCodeRuntimeValue &function, const GCodeSyscallArguments &args) {
+    this->dictionaryArgs.clear();
+    args.copyTo(this->dictionaryArgs);
+    this->syscall(type, function, this->dictionaryArgs);
+  }
+
   GCodeFunctionScope &GCodeInterpreter::getFunctions() {
     return this->functions;
   }
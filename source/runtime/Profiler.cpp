@@ -0,0 +1,202 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "gcodelib/runtime/Profiler.h"
+#include "gcodelib/runtime/Error.h"
+#include <algorithm>
+#include <map>
+#include <ostream>
+
+namespace GCodeLib::Runtime {
+
+  GCodeProfiler::GCodeProfiler(const GCodeIRModule &module, std::size_t sampleInterval)
+    : module(module), sampleInterval(sampleInterval) {
+    if (sampleInterval == 0) {
+      throw GCodeRuntimeError("Profiler sample interval must be positive");
+    }
+    this->reset();
+  }
+
+  void GCodeProfiler::reset() {
+    this->countdown = this->sampleInterval;
+    this->lastAddress = 0;
+    this->lastSample = Clock::now();
+    this->opcodes.fill(0);
+    this->opcodeAllocations.fill(GCodeAllocationStatistics{});
+    this->lastOpcode = 0;
+    this->allocationMark = GCodeAllocationCounter::getThreadTotals();
+    this->addresses.assign(this->module.length(), GCodeProfileCounter{});
+    this->nodes.clear();
+    this->nodes.push_back(Node { 0, Root, 1, GCodeProfileCounter{}, {} });
+    this->current = Root;
+  }
+
+  const GCodeIRModule &GCodeProfiler::getModule() const {
+    return this->module;
+  }
+
+  uint64_t GCodeProfiler::getInstructions() const {
+    uint64_t instructions = 0;
+    for (uint64_t count : this->opcodes) {
+      instructions += count;
+    }
+    return instructions;
+  }
+
+  std::chrono::nanoseconds GCodeProfiler::getTime() const {
+    std::chrono::nanoseconds time{0};
+    for (const auto &node : this->nodes) {
+      time += node.self.time;
+    }
+    return time;
+  }
+
+  uint64_t GCodeProfiler::getOpcodeCount(GCodeIROpcode opcode) const {
+    return this->opcodes[static_cast<std::size_t>(opcode)];
+  }
+
+  GCodeAllocationStatistics GCodeProfiler::getOpcodeAllocations(GCodeIROpcode opcode) const {
+    return this->opcodeAllocations[static_cast<std::size_t>(opcode)];
+  }
+
+  std::vector<GCodeProfileLine> GCodeProfiler::getLines() const {
+    std::map<std::pair<std::string, uint32_t>, GCodeProfileCounter> counters;
+    for (std::size_t address = 0; address < this->addresses.size(); address++) {
+      const GCodeProfileCounter &counter = this->addresses[address];
+      if (counter.instructions == 0 && counter.time.count() == 0) {
+        continue;
+      }
+      std::optional<Parser::SourcePosition> position = this->module.getSourceMap().locate(address);
+      if (position.has_value()) {
+        GCodeProfileCounter &line = counters[std::make_pair(position->getTag(), position->getLine())];
+        line.instructions += counter.instructions;
+        line.time += counter.time;
+      }
+    }
+    std::vector<GCodeProfileLine> lines;
+    for (const auto &entry : counters) {
+      lines.push_back(GCodeProfileLine { entry.first.first, entry.first.second, entry.second });
+    }
+    return lines;
+  }
+
+  std::vector<GCodeProfileProcedure> GCodeProfiler::getProcedures() const {
+    std::vector<GCodeProfileProcedure> procedures;
+    for (std::size_t index = Root + 1; index < this->nodes.size(); index++) {
+      const Node &node = this->nodes[index];
+      auto it = std::find_if(procedures.begin(), procedures.end(), [&](const GCodeProfileProcedure &proc) {
+        return proc.id == node.procedure;
+      });
+      if (it == procedures.end()) {
+        GCodeProfileProcedure procedure;
+        procedure.id = node.procedure;
+        procedures.push_back(procedure);
+        it = procedures.end() - 1;
+      }
+      it->calls += node.calls;
+      it->exclusive.instructions += node.self.instructions;
+      it->exclusive.time += node.self.time;
+      bool recursive = false;
+      for (std::size_t parent = node.parent; parent != Root; parent = this->nodes[parent].parent) {
+        recursive = recursive || this->nodes[parent].procedure == node.procedure;
+      }
+      if (!recursive) {
+        GCodeProfileCounter counter = this->inclusive(index);
+        it->inclusive.instructions += counter.instructions;
+        it->inclusive.time += counter.time;
+      }
+    }
+    return procedures;
+  }
+
+  GCodeProfileCounter GCodeProfiler::inclusive(std::size_t index) const {
+    const Node &node = this->nodes[index];
+    GCodeProfileCounter counter = node.self;
+    for (const auto &child : node.children) {
+      GCodeProfileCounter childCounter = this->inclusive(child.second);
+      counter.instructions += childCounter.instructions;
+      counter.time += childCounter.time;
+    }
+    return counter;
+  }
+
+  void GCodeProfiler::writeFolded(std::ostream &os, GCodeProfileMetric metric) const {
+    this->writeFolded(os, Root, "main", metric);
+  }
+
+  void GCodeProfiler::writeFolded(std::ostream &os, std::size_t index, const std::string &stack, GCodeProfileMetric metric) const {
+    const Node &node = this->nodes[index];
+    uint64_t weight = metric == GCodeProfileMetric::Instructions
+      ? node.self.instructions
+      : static_cast<uint64_t>(node.self.time.count());
+    if (weight > 0) {
+      os << stack << ' ' << weight << std::endl;
+    }
+    for (const auto &child : node.children) {
+      this->writeFolded(os, child.second, stack + ";o" + std::to_string(child.first), metric);
+    }
+  }
+
+  void GCodeProfiler::resume() {
+    this->lastSample = Clock::now();
+    this->allocationMark = GCodeAllocationCounter::getThreadTotals();
+  }
+
+  void GCodeProfiler::suspend() {
+    this->account();
+    this->sample();
+  }
+
+  // Heap activity since the previous instruction is charged to that instruction's opcode
+  void GCodeProfiler::account() {
+    GCodeAllocationStatistics totals = GCodeAllocationCounter::getThreadTotals();
+    if (totals.allocations != this->allocationMark.allocations) {
+      this->opcodeAllocations[this->lastOpcode] += totals - this->allocationMark;
+      this->allocationMark = totals;
+    }
+  }
+
+  void GCodeProfiler::sample() {
+    Clock::time_point now = Clock::now();
+    std::chrono::nanoseconds elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - this->lastSample);
+    this->nodes[this->current].self.time += elapsed;
+    if (this->lastAddress < this->addresses.size()) {
+      this->addresses[this->lastAddress].time += elapsed;
+    }
+    this->lastSample = now;
+    this->countdown = this->sampleInterval;
+  }
+
+  void GCodeProfiler::enter(int64_t procedure) {
+    Node &node = this->nodes[this->current];
+    auto it = std::find_if(node.children.begin(), node.children.end(), [&](const auto &child) {
+      return child.first == procedure;
+    });
+    std::size_t index;
+    if (it != node.children.end()) {
+      index = it->second;
+    } else {
+      index = this->nodes.size();
+      node.children.emplace_back(procedure, index);
+      this->nodes.push_back(Node { procedure, this->current, 0, GCodeProfileCounter{}, {} });
+    }
+    this->nodes[index].calls++;
+    this->current = index;
+  }
+
+  void GCodeProfiler::leave() {
+    if (this->current != Root) {
+      this->current = this->nodes[this->current].parent;
+    }
+  }
+}
\ No newline at end of file
@@ -13,6 +13,7 @@
 
 #include "gcodelib/runtime/Runtime.h"
 #include "gcodelib/runtime/Error.h"
+#include <algorithm>
 #include <cmath>
 
 namespace GCodeLib::Runtime {
@@ -32,6 +33,64 @@ namespace GCodeLib::Runtime {
     }
   }
 
+  static bool same_value(const GCodeRuntimeValue &v1, const GCodeRuntimeValue &v2) {
+    if (v1.getType() != v2.getType()) {
+      return false;
+    }
+    switch (v1.getType()) {
+      case GCodeRuntimeValue::Type::Integer:
+        return v1.getInteger() == v2.getInteger();
+      case GCodeRuntimeValue::Type::Float:
+        return v1.getFloat() == v2.getFloat();
+      case GCodeRuntimeValue::Type::String:
+        return v1.getString() == v2.getString();
+      default:
+        return true;
+    }
+  }
+
+  template <typename T>
+  static std::shared_ptr<const T> share_entries(T &&entries, const std::shared_ptr<const T> &previous) {
+    if (previous != nullptr && previous->size() == entries.size() &&
+      std::equal(entries.begin(), entries.end(), previous->begin(), [](const auto &e1, const auto &e2) {
+        return e1.first == e2.first && same_value(e1.second, e2.second);
+      })) {
+      return previous;
+    } else {
+      return std::make_shared<const T>(std::move(entries));
+    }
+  }
+
+  template <typename N>
+  static GCodeRuntimeSnapshot::Scope snapshot_scope(const N &numbered, const GCodeScopedDictionary<std::string> &named,
+    const GCodeRuntimeSnapshot::Scope *previous) {
+    GCodeRuntimeSnapshot::NumberedEntries numberedEntries;
+    numbered.visitOwn([&](int64_t key, const GCodeRuntimeValue &value) {
+      numberedEntries.emplace_back(key, value);
+    });
+    GCodeRuntimeSnapshot::NamedEntries namedEntries(named.begin(), named.end());
+    GCodeRuntimeSnapshot::Scope scope;
+    scope.numbered = share_entries(std::move(numberedEntries), previous ? previous->numbered : nullptr);
+    scope.named = share_entries(std::move(namedEntries), previous ? previous->named : nullptr);
+    return scope;
+  }
+
+  template <typename N>
+  static void restore_scope(N &numbered, GCodeScopedDictionary<std::string> &named, const GCodeRuntimeSnapshot::Scope &scope) {
+    numbered.clear();
+    named.clear();
+    if (scope.numbered != nullptr) {
+      for (const auto &entry : *scope.numbered) {
+        numbered.putOwn(entry.first, entry.second);
+      }
+    }
+    if (scope.named != nullptr) {
+      for (const auto &entry : *scope.named) {
+        named.putOwn(entry.first, entry.second);
+      }
+    }
+  }
+
   template <typename ... T>
   struct AssertNumericImpl {};
 
@@ -54,13 +113,92 @@ namespace GCodeLib::Runtime {
   }
 
   GCodeRuntimeState::GCodeRuntimeState(GCodeVariableScope &system, const GCodeRuntimeConfig &config)
-    : pc(0), config(config) {
-    this->scopes.push(std::make_unique<GCodeCascadeVariableScope>(&system));
-    this->globalScope = this->scopes.top().get();
+    : GCodeRuntimeState(system, config, config.getCallStackDepth()) {}
+
+  GCodeRuntimeState::GCodeRuntimeState(GCodeVariableScope &system, const GCodeRuntimeConfig &config, std::size_t frames)
+    : globalScope(std::make_unique<GCodeDenseVariableScope>(&system)), pc(0), config(config) {
+    this->frames.reserve(frames);
+  }
+
+  GCodeRuntimeState GCodeRuntimeState::fork(GCodeVariableScope &system, const GCodeRuntimeConfig &config) const {
+    GCodeRuntimeState branch(system, config, this->call_stack.get().size());
+    branch.syscallArgs = this->syscallArgs;
+    branch.stack = this->stack;
+    branch.call_stack = this->call_stack;
+    branch.pc = this->pc;
+    branch.globalScope->getNumbered().copyOwn(this->globalScope->getNumbered());
+    branch.globalScope->getNamed().copyOwn(this->globalScope->getNamed());
+    for (std::size_t depth = 0; depth < this->call_stack.get().size(); depth++) {
+      GCodeFrameVariableScope &frame = branch.frames.emplace_back(branch.globalScope.get());
+      frame.getNumbered().copyOwn(this->frames[depth].getNumbered());
+      frame.getNamed().copyOwn(this->frames[depth].getNamed());
+    }
+    return branch;
   }
 
   GCodeVariableScope &GCodeRuntimeState::getScope() {
-    return *this->scopes.top();
+    if (this->call_stack.get().empty()) {
+      return *this->globalScope;
+    } else {
+      return this->frames[this->call_stack.get().size() - 1];
+    }
+  }
+
+  std::size_t GCodeRuntimeState::getCallDepth() const {
+    return this->call_stack.get().size();
+  }
+
+  GCodeSyscallArguments &GCodeRuntimeState::getSyscallArguments() {
+    return this->syscallArgs;
+  }
+
+  GCodeRuntimeSnapshot GCodeRuntimeState::snapshot(const GCodeRuntimeSnapshot *previous) const {
+    GCodeRuntimeSnapshot snapshot;
+    snapshot.pc = this->pc;
+    snapshot.stack = this->stack.get();
+    snapshot.callStack = this->call_stack.get();
+    const GCodeDenseVariableScope &global = *this->globalScope;
+    snapshot.global = snapshot_scope(global.getNumbered(), global.getNamed(),
+      previous ? &previous->global : nullptr);
+    for (std::size_t depth = 0; depth < snapshot.callStack.size(); depth++) {
+      const GCodeFrameVariableScope &frame = this->frames[depth];
+      snapshot.frames.push_back(snapshot_scope(frame.getNumbered(), frame.getNamed(),
+        previous && depth < previous->frames.size() ? &previous->frames[depth] : nullptr));
+    }
+    uint32_t mask = this->syscallArgs.getMask();
+    for (unsigned char key = 'A'; mask != 0; key++, mask >>= 1) {
+      if (mask & 1) {
+        snapshot.arguments.emplace_back(key, this->syscallArgs.getValue(key));
+      }
+    }
+    return snapshot;
+  }
+
+  void GCodeRuntimeState::restore(const GCodeRuntimeSnapshot &snapshot) {
+    if (snapshot.frames.size() != snapshot.callStack.size()) {
+      throw GCodeRuntimeError("Malformed snapshot: call stack and frames do not match");
+    } else if (snapshot.callStack.size() > this->config.get().getCallStackDepth()) {
+      throw GCodeRuntimeError("Call stack overflow");
+    }
+    this->pc = snapshot.pc;
+    this->stack.mutate() = snapshot.stack;
+    this->call_stack.mutate() = snapshot.callStack;
+    restore_scope(this->globalScope->getNumbered(), this->globalScope->getNamed(), snapshot.global);
+    for (auto &frame : this->frames) {
+      frame.reset();
+    }
+    for (std::size_t depth = 0; depth < snapshot.frames.size(); depth++) {
+      if (depth == this->frames.size()) {
+        this->frames.emplace_back(this->globalScope.get());
+      }
+      restore_scope(this->frames[depth].getNumbered(), this->frames[depth].getNamed(), snapshot.frames[depth]);
+    }
+    this->syscallArgs.clear();
+    for (const auto &argument : snapshot.arguments) {
+      if (!this->syscallArgs.put(argument.first, argument.second)) {
+        throw GCodeRuntimeError("Invalid syscall argument \'" + std::string(1, argument.first) + "\'");
+      }
+    }
   }
 
   std::size_t GCodeRuntimeState::getPC() const {
@@ -76,45 +214,54 @@ namespace GCodeLib::Runtime {
   }
 
   void GCodeRuntimeState::call(std::size_t pc) {
-    this->call_stack.push(this->pc);
-    this->scopes.push(std::make_unique<GCodeCascadeVariableScope>(this->globalScope));
+    std::size_t depth = this->call_stack.get().size();
+    if (depth >= this->config.get().getCallStackDepth()) {
+      throw GCodeRuntimeError("Call stack overflow");
+    }
+    if (depth == this->frames.size()) {
+      this->frames.emplace_back(this->globalScope.get());
+    }
+    this->call_stack.mutate().push_back(this->pc);
     this->pc = pc;
   }
 
   void GCodeRuntimeState::ret() {
-    if (this->call_stack.empty()) {
+    std::vector<std::size_t> &call_stack = this->call_stack.mutate();
+    if (call_stack.empty()) {
       throw GCodeRuntimeError("Call stack undeflow");
     }
-    this->pc = this->call_stack.top();
-    this->call_stack.pop();
-    this->scopes.pop();
+    this->frames[call_stack.size() - 1].reset();
+    this->pc = call_stack.back();
+    call_stack.pop_back();
   }
 
   void GCodeRuntimeState::push(const GCodeRuntimeValue &value) {
-    this->stack.push(value);
+    this->stack.mutate().push_back(value);
   }
 
   GCodeRuntimeValue GCodeRuntimeState::pop() {
-    if (this->stack.empty()) {
+    std::vector<GCodeRuntimeValue> &stack = this->stack.mutate();
+    if (stack.empty()) {
       throw GCodeRuntimeError("Stack underflow");
     }
-    GCodeRuntimeValue value = this->stack.top();
-    this->stack.pop();
+    GCodeRuntimeValue value = stack.back();
+    stack.pop_back();
     return value;
   }
 
   const GCodeRuntimeValue &GCodeRuntimeState::peek() {
-    if (this->stack.empty()) {
+    if (this->stack.get().empty()) {
       throw GCodeRuntimeError("Stack underflow");
     }
-    return this->stack.top();
+    return this->stack.get().back();
   }
 
   void GCodeRuntimeState::dup() {
-    if (this->stack.empty()) {
+    std::vector<GCodeRuntimeValue> &stack = this->stack.mutate();
+    if (stack.empty()) {
       throw GCodeRuntimeError("Stack underflow");
     }
-    this->stack.push(this->stack.top());
+    stack.push_back(stack.back());
   }
   
   void GCodeRuntimeState::negate() {
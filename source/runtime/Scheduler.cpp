@@ -0,0 +1,360 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "gcodelib/runtime/Scheduler.h"
+#include <algorithm>
+
+namespace GCodeLib::Runtime {
+
+  static thread_local const GCodeJobScheduler *current_scheduler = nullptr;
+  static thread_local std::size_t current_worker = 0;
+
+  static void accumulate(GCodeJobStatistics &total, const GCodeJobStatistics &stats) {
+    total.slices += stats.slices;
+    total.commands += stats.commands;
+    total.stalls += stats.stalls;
+    total.runTime += stats.runTime;
+    total.totalLatency += stats.totalLatency;
+    total.maxLatency = std::max(total.maxLatency, stats.maxLatency);
+  }
+
+  std::chrono::nanoseconds GCodeJobStatistics::getMeanLatency() const {
+    return this->slices > 0
+      ? this->totalLatency / static_cast<std::chrono::nanoseconds::rep>(this->slices)
+      : std::chrono::nanoseconds(0);
+  }
+
+  GCodeScheduledJob::GCodeScheduledJob(GCodeJobScheduler &scheduler, GCodeInterpreter &interpreter, unsigned int priority, std::size_t queueCapacity, std::size_t batchSize)
+    : scheduler(scheduler), interpreter(interpreter), priority(priority), queue(queueCapacity > 0 ? queueCapacity : 1),
+      batch(batchSize > 0 ? batchSize : 1), state(State::Runnable), cancelled(false),
+      awaitingAck(false), published(0), applied(0), popped(0), released(false) {}
+
+  bool GCodeScheduledJob::tryPop(GCodeCommandRecord &record) {
+    this->applied.store(this->popped, std::memory_order_release);
+    bool received = this->queue.tryPop(record);
+    if (received) {
+      this->popped++;
+    }
+    this->resume();
+    return received;
+  }
+
+  void GCodeScheduledJob::complete() {
+    this->applied.store(this->popped, std::memory_order_release);
+    this->resume();
+  }
+
+  void GCodeScheduledJob::cancel() {
+    this->cancelled = true;
+    State expected = State::Blocked;
+    this->state.compare_exchange_strong(expected, State::Cancelled);
+  }
+
+  GCodeScheduledJob::State GCodeScheduledJob::getState() const {
+    return this->state.load();
+  }
+
+  bool GCodeScheduledJob::isDone() const {
+    State state = this->state.load();
+    return (state == State::Finished || state == State::Failed || state == State::Cancelled) &&
+      this->queue.empty();
+  }
+
+  unsigned int GCodeScheduledJob::getPriority() const {
+    return this->priority;
+  }
+
+  GCodeJobStatistics GCodeScheduledJob::getStatistics() const {
+    std::lock_guard<std::mutex> lock(this->statisticsMutex);
+    return this->statistics;
+  }
+
+  std::optional<GCodeRuntimeError> GCodeScheduledJob::getError() const {
+    if (this->state.load() == State::Failed) {
+      return this->error;
+    } else {
+      return std::optional<GCodeRuntimeError>();
+    }
+  }
+
+  bool GCodeScheduledJob::hasRoom() const {
+    return this->queue.size() < this->queue.capacity();
+  }
+
+  bool GCodeScheduledJob::canResume() const {
+    return this->cancelled || (this->hasRoom() &&
+      (!this->awaitingAck || this->applied.load(std::memory_order_acquire) == this->published));
+  }
+
+  bool GCodeScheduledJob::wake() {
+    State expected = State::Blocked;
+    return this->state.compare_exchange_strong(expected, State::Runnable);
+  }
+
+  void GCodeScheduledJob::resume() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->state.load() == State::Blocked && this->canResume() && this->wake()) {
+      this->scheduler.enqueue(*this);
+    }
+  }
+
+  GCodeJobScheduler::GCodeJobScheduler(std::size_t workerCount, std::size_t quantum)
+    : quantum(quantum > 0 ? quantum : 1), retiredJobs(0), queued(0), nextWorker(0), steals(0), sleeping(0), stopping(false) {
+    if (workerCount == 0) {
+      workerCount = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < workerCount; i++) {
+      this->workers.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < workerCount; i++) {
+      this->workers[i]->thread = std::thread([this, i]() {
+        this->work(i);
+      });
+    }
+  }
+
+  GCodeJobScheduler::~GCodeJobScheduler() {
+    this->shutdown();
+  }
+
+  GCodeScheduledJob &GCodeJobScheduler::submit(GCodeInterpreter &interpreter, unsigned int priority, std::size_t queueCapacity, std::size_t batchSize) {
+    if (priority == 0) {
+      throw GCodeRuntimeError("Job priority must be positive");
+    } else if (this->stopping) {
+      throw GCodeRuntimeError("Job scheduler is stopped");
+    }
+    interpreter.start();
+    std::unique_ptr<GCodeScheduledJob> job = std::make_unique<GCodeScheduledJob>(*this, interpreter, priority, queueCapacity, batchSize);
+    GCodeScheduledJob &ref = *job;
+    {
+      std::lock_guard<std::mutex> lock(this->jobsMutex);
+      this->jobs.push_back(std::move(job));
+    }
+    this->enqueue(ref);
+    return ref;
+  }
+
+  // Jobs that are still running are cancelled and dropped once their worker lets go of them
+  void GCodeJobScheduler::release(GCodeScheduledJob &job) {
+    job.cancel();
+    std::lock_guard<std::mutex> lock(this->jobsMutex);
+    job.released = true;
+    GCodeScheduledJob::State state = job.state.load();
+    if (state == GCodeScheduledJob::State::Finished || state == GCodeScheduledJob::State::Failed ||
+      state == GCodeScheduledJob::State::Cancelled) {
+      this->retire(job);
+    }
+  }
+
+  void GCodeJobScheduler::shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(this->idleMutex);
+      this->stopping = true;
+    }
+    this->idle.notify_all();
+    for (auto &worker : this->workers) {
+      if (worker->thread.joinable()) {
+        worker->thread.join();
+      }
+      worker->jobs.clear();
+    }
+    this->queued = 0;
+    std::lock_guard<std::mutex> lock(this->jobsMutex);
+    std::vector<GCodeScheduledJob *> released;
+    for (auto &job : this->jobs) {
+      GCodeScheduledJob::State state = job->state.load();
+      if (state == GCodeScheduledJob::State::Runnable || state == GCodeScheduledJob::State::Blocked) {
+        job->state = GCodeScheduledJob::State::Cancelled;
+      }
+      if (job->released) {
+        released.push_back(job.get());
+      }
+    }
+    for (GCodeScheduledJob *job : released) {
+      this->retire(*job);
+    }
+  }
+
+  std::size_t GCodeJobScheduler::getWorkerCount() const {
+    return this->workers.size();
+  }
+
+  std::size_t GCodeJobScheduler::getQuantum() const {
+    return this->quantum;
+  }
+
+  GCodeSchedulerStatistics GCodeJobScheduler::getStatistics() const {
+    GCodeSchedulerStatistics result;
+    result.steals = this->steals;
+    std::lock_guard<std::mutex> lock(this->jobsMutex);
+    result.jobs = this->retiredJobs + this->jobs.size();
+    result.total = this->retired;
+    for (const auto &job : this->jobs) {
+      accumulate(result.total, job->getStatistics());
+    }
+    return result;
+  }
+
+  void GCodeJobScheduler::enqueue(GCodeScheduledJob &job) {
+    if (this->stopping) {
+      job.state = GCodeScheduledJob::State::Cancelled;
+      return;
+    }
+    std::size_t index = current_scheduler == this
+      ? current_worker
+      : this->nextWorker++ % this->workers.size();
+    job.readySince = std::chrono::steady_clock::now();
+    {
+      std::lock_guard<std::mutex> lock(this->workers[index]->mutex);
+      this->workers[index]->jobs.push_back(&job);
+    }
+    this->queued++;
+    if (this->sleeping > 0) {
+      {
+        std::lock_guard<std::mutex> lock(this->idleMutex);
+      }
+      this->idle.notify_one();
+    }
+  }
+
+  GCodeScheduledJob *GCodeJobScheduler::take(std::size_t index) {
+    for (std::size_t i = 0; i < this->workers.size(); i++) {
+      Worker &worker = *this->workers[(index + i) % this->workers.size()];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      if (!worker.jobs.empty()) {
+        GCodeScheduledJob *job = worker.jobs.front();
+        worker.jobs.pop_front();
+        this->queued--;
+        if (i > 0) {
+          this->steals++;
+        }
+        return job;
+      }
+    }
+    return nullptr;
+  }
+
+  void GCodeJobScheduler::work(std::size_t index) {
+    current_scheduler = this;
+    current_worker = index;
+    while (!this->stopping) {
+      GCodeScheduledJob *job = this->take(index);
+      if (job != nullptr) {
+        this->runSlice(*job);
+      } else {
+        std::unique_lock<std::mutex> lock(this->idleMutex);
+        this->sleeping++;
+        this->idle.wait(lock, [this]() {
+          return this->queued > 0 || this->stopping;
+        });
+        this->sleeping--;
+      }
+    }
+    current_scheduler = nullptr;
+  }
+
+  void GCodeJobScheduler::runSlice(GCodeScheduledJob &job) {
+    using State = GCodeScheduledJob::State;
+    auto start = std::chrono::steady_clock::now();
+    if (job.cancelled) {
+      this->finish(job, State::Cancelled);
+      return;
+    }
+    job.state = State::Running;
+    std::size_t commands = 0;
+    bool awaitingAck = false;
+    State next = State::Runnable;
+    try {
+      std::size_t room = job.queue.capacity() - job.queue.size();
+      if (room > 0) {
+        // Unacknowledged commands may still be writing the system scope, so the batch must not probe it
+        GCodeSystemScopeAccess access = job.applied.load(std::memory_order_acquire) == job.published
+          ? GCodeSystemScopeAccess::Synchronized : GCodeSystemScopeAccess::Unsynchronized;
+        GCodeCommandSpan span = job.interpreter.executeBatch(job.batch.data(),
+          std::min(room, job.batch.size()), this->quantum * job.priority, access);
+        for (const auto &record : span) {
+          job.queue.tryPush(record);
+        }
+        commands = span.size();
+        job.published += commands;
+        awaitingAck = job.interpreter.isWaitingForSystemScope();
+      }
+      if (job.interpreter.isFinished()) {
+        next = State::Finished;
+      } else if (!job.hasRoom()) {
+        next = State::Blocked;
+      } else if (awaitingAck && job.applied.load(std::memory_order_acquire) != job.published) {
+        next = State::Blocked;
+      }
+    } catch (const GCodeRuntimeError &ex) {
+      job.error = ex;
+      next = State::Failed;
+    } catch (const std::exception &ex) {
+      job.error = GCodeRuntimeError(ex.what());
+      next = State::Failed;
+    }
+    auto end = std::chrono::steady_clock::now();
+    {
+      std::lock_guard<std::mutex> lock(job.statisticsMutex);
+      auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(start - job.readySince);
+      job.statistics.slices++;
+      job.statistics.commands += commands;
+      job.statistics.runTime += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+      job.statistics.totalLatency += latency;
+      job.statistics.maxLatency = std::max(job.statistics.maxLatency, latency);
+      if (next == State::Blocked) {
+        job.statistics.stalls++;
+      }
+    }
+    if (next == State::Runnable) {
+      if (job.cancelled) {
+        this->finish(job, State::Cancelled);
+      } else {
+        job.state = State::Runnable;
+        this->enqueue(job);
+      }
+    } else if (next == State::Blocked) {
+      // Once blocked, the consumer may wake, cancel and release the job at any time; holding the job list
+      // lock keeps it alive until the re-check is done
+      std::lock_guard<std::mutex> lock(this->jobsMutex);
+      job.awaitingAck = awaitingAck;
+      job.state = State::Blocked;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (job.canResume() && job.wake()) {
+        this->enqueue(job);
+      }
+    } else {
+      this->finish(job, next);
+    }
+  }
+
+  void GCodeJobScheduler::finish(GCodeScheduledJob &job, GCodeScheduledJob::State state) {
+    std::lock_guard<std::mutex> lock(this->jobsMutex);
+    job.state = state;
+    if (job.released) {
+      this->retire(job);
+    }
+  }
+
+  // Expects the job list lock to be held
+  void GCodeJobScheduler::retire(GCodeScheduledJob &job) {
+    accumulate(this->retired, job.getStatistics());
+    this->retiredJobs++;
+    auto it = std::find_if(this->jobs.begin(), this->jobs.end(), [&](const auto &entry) {
+      return entry.get() == &job;
+    });
+    if (it != this->jobs.end()) {
+      this->jobs.erase(it);
+    }
+  }
+}
\ No newline at end of file
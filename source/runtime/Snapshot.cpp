@@ -0,0 +1,300 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "gcodelib/runtime/Snapshot.h"
+#include "gcodelib/runtime/Error.h"
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace GCodeLib::Runtime {
+
+  namespace {
+
+    constexpr uint16_t ByteOrder = 0x0102;
+
+    class SnapshotEncoder {
+     public:
+      SnapshotEncoder(std::ostream &os)
+        : os(os) {}
+
+      template <typename T>
+      void put(const T &value) {
+        this->os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+      }
+
+      void putVarint(uint64_t value) {
+        while (value >= 0x80) {
+          this->put<uint8_t>(static_cast<uint8_t>((value & 0x7f) | 0x80));
+          value >>= 7;
+        }
+        this->put<uint8_t>(static_cast<uint8_t>(value));
+      }
+
+      void putString(const std::string &str) {
+        this->putVarint(str.size());
+        this->os.write(str.data(), str.size());
+      }
+
+      void putValue(const GCodeRuntimeValue &value) {
+        this->put<uint8_t>(static_cast<uint8_t>(value.getType()));
+        switch (value.getType()) {
+          case GCodeRuntimeValue::Type::Integer:
+            this->putVarint((static_cast<uint64_t>(value.getInteger()) << 1) ^ static_cast<uint64_t>(value.getInteger() >> 63));
+            break;
+          case GCodeRuntimeValue::Type::Float:
+            this->put<double>(value.getFloat());
+            break;
+          case GCodeRuntimeValue::Type::String:
+            this->putString(value.getString());
+            break;
+          default:
+            break;
+        }
+      }
+
+      void putScope(const GCodeRuntimeSnapshot::Scope &scope) {
+        if (scope.numbered != nullptr) {
+          this->putVarint(scope.numbered->size());
+          int64_t previous = 0;
+          for (const auto &entry : *scope.numbered) {
+            int64_t delta = entry.first - previous;
+            this->putVarint((static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+            this->putValue(entry.second);
+            previous = entry.first;
+          }
+        } else {
+          this->putVarint(0);
+        }
+        if (scope.named != nullptr) {
+          this->putVarint(scope.named->size());
+          for (const auto &entry : *scope.named) {
+            this->putString(entry.first);
+            this->putValue(entry.second);
+          }
+        } else {
+          this->putVarint(0);
+        }
+      }
+     private:
+      std::ostream &os;
+    };
+
+    class SnapshotDecoder {
+     public:
+      SnapshotDecoder(std::istream &is)
+        : is(is) {}
+
+      template <typename T>
+      T get() {
+        T value;
+        this->take(reinterpret_cast<char *>(&value), sizeof(T));
+        return value;
+      }
+
+      uint64_t getVarint() {
+        uint64_t value = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+          uint8_t byte = this->get<uint8_t>();
+          value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+          if ((byte & 0x80) == 0) {
+            return value;
+          }
+        }
+        throw GCodeRuntimeError("Malformed snapshot: varint overflow");
+      }
+
+      int64_t getSigned() {
+        uint64_t value = this->getVarint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+      }
+
+      std::size_t getCount() {
+        uint64_t count = this->getVarint();
+        if (count > MaxCount) {
+          throw GCodeRuntimeError("Malformed snapshot: section is too large");
+        }
+        return static_cast<std::size_t>(count);
+      }
+
+      // Counts are untrusted, so storage only grows as records are actually read
+      template <typename Container, typename Reader>
+      void getSequence(Container &container, Reader reader) {
+        std::size_t count = this->getCount();
+        container.clear();
+        container.reserve(std::min<std::size_t>(count, ChunkSize));
+        for (std::size_t i = 0; i < count; i++) {
+          container.push_back(reader());
+        }
+      }
+
+      std::string getString() {
+        std::size_t length = this->getCount();
+        std::string str;
+        while (str.size() < length) {
+          std::size_t offset = str.size();
+          str.resize(offset + std::min<std::size_t>(length - offset, ChunkSize));
+          this->take(&str[offset], str.size() - offset);
+        }
+        return str;
+      }
+
+      GCodeRuntimeValue getValue() {
+        switch (static_cast<GCodeRuntimeValue::Type>(this->get<uint8_t>())) {
+          case GCodeRuntimeValue::Type::None:
+            return GCodeRuntimeValue::Empty;
+          case GCodeRuntimeValue::Type::Integer:
+            return GCodeRuntimeValue(this->getSigned());
+          case GCodeRuntimeValue::Type::Float:
+            return GCodeRuntimeValue(this->get<double>());
+          case GCodeRuntimeValue::Type::String:
+            return GCodeRuntimeValue(this->getString());
+          default:
+            throw GCodeRuntimeError("Malformed snapshot: unknown value type");
+        }
+      }
+
+      GCodeRuntimeSnapshot::Scope getScope() {
+        GCodeRuntimeSnapshot::Scope scope;
+        auto numbered = std::make_shared<GCodeRuntimeSnapshot::NumberedEntries>();
+        int64_t previous = 0;
+        this->getSequence(*numbered, [&]() {
+          previous += this->getSigned();
+          return std::make_pair(previous, this->getValue());
+        });
+        auto named = std::make_shared<GCodeRuntimeSnapshot::NamedEntries>();
+        this->getSequence(*named, [&]() {
+          std::string key = this->getString();
+          return std::make_pair(std::move(key), this->getValue());
+        });
+        scope.numbered = std::move(numbered);
+        scope.named = std::move(named);
+        return scope;
+      }
+     private:
+      void take(char *data, std::size_t length) {
+        if (!this->is.read(data, length)) {
+          throw GCodeRuntimeError("Malformed snapshot: unexpected end of stream");
+        }
+      }
+
+      static constexpr uint64_t MaxCount = 1ULL << 24;
+      static constexpr std::size_t ChunkSize = 4096;
+      std::istream &is;
+    };
+
+    std::size_t value_footprint(const GCodeRuntimeValue &value) {
+      return sizeof(GCodeRuntimeValue) + (value.is(GCodeRuntimeValue::Type::String) ? value.getString().capacity() : 0);
+    }
+
+    std::size_t scope_footprint(const GCodeRuntimeSnapshot::Scope &scope) {
+      std::size_t footprint = 0;
+      if (scope.numbered != nullptr) {
+        footprint += sizeof(*scope.numbered) + scope.numbered->capacity() * sizeof(int64_t);
+        for (const auto &entry : *scope.numbered) {
+          footprint += value_footprint(entry.second);
+        }
+      }
+      if (scope.named != nullptr) {
+        footprint += sizeof(*scope.named);
+        for (const auto &entry : *scope.named) {
+          footprint += sizeof(std::string) + entry.first.capacity() + value_footprint(entry.second);
+        }
+      }
+      return footprint;
+    }
+  }
+
+  std::size_t GCodeRuntimeSnapshot::getFootprint() const {
+    std::size_t footprint = sizeof(GCodeRuntimeSnapshot) +
+      this->callStack.capacity() * sizeof(std::size_t) +
+      this->frames.capacity() * sizeof(Scope) +
+      scope_footprint(this->global);
+    for (const auto &value : this->stack) {
+      footprint += value_footprint(value);
+    }
+    for (const auto &frame : this->frames) {
+      footprint += scope_footprint(frame);
+    }
+    for (const auto &argument : this->arguments) {
+      footprint += sizeof(argument.first) + value_footprint(argument.second);
+    }
+    return footprint;
+  }
+
+  void GCodeRuntimeSnapshot::write(std::ostream &os) const {
+    SnapshotEncoder encoder(os);
+    os.write(GCodeRuntimeSnapshot::Magic, sizeof(GCodeRuntimeSnapshot::Magic));
+    encoder.put<uint16_t>(GCodeRuntimeSnapshot::Version);
+    encoder.put<uint16_t>(ByteOrder);
+    encoder.putVarint(this->pc);
+    encoder.putVarint(this->commands);
+    encoder.putVarint(this->stack.size());
+    for (const auto &value : this->stack) {
+      encoder.putValue(value);
+    }
+    encoder.putVarint(this->callStack.size());
+    for (std::size_t address : this->callStack) {
+      encoder.putVarint(address);
+    }
+    encoder.putScope(this->global);
+    encoder.putVarint(this->frames.size());
+    for (const auto &frame : this->frames) {
+      encoder.putScope(frame);
+    }
+    encoder.putVarint(this->arguments.size());
+    for (const auto &argument : this->arguments) {
+      encoder.put<uint8_t>(argument.first);
+      encoder.putValue(argument.second);
+    }
+    if (!os) {
+      throw GCodeRuntimeError("Unable to write runtime snapshot");
+    }
+  }
+
+  GCodeRuntimeSnapshot GCodeRuntimeSnapshot::read(std::istream &is) {
+    SnapshotDecoder decoder(is);
+    char magic[sizeof(GCodeRuntimeSnapshot::Magic)];
+    for (char &chr : magic) {
+      chr = decoder.get<char>();
+    }
+    if (std::memcmp(magic, GCodeRuntimeSnapshot::Magic, sizeof(magic)) != 0) {
+      throw GCodeRuntimeError("Malformed snapshot: bad magic");
+    }
+    if (decoder.get<uint16_t>() != GCodeRuntimeSnapshot::Version) {
+      throw GCodeRuntimeError("Unsupported snapshot version");
+    }
+    if (decoder.get<uint16_t>() != ByteOrder) {
+      throw GCodeRuntimeError("Snapshot byte order does not match the host");
+    }
+    GCodeRuntimeSnapshot snapshot;
+    snapshot.pc = static_cast<std::size_t>(decoder.getVarint());
+    snapshot.commands = static_cast<std::size_t>(decoder.getVarint());
+    decoder.getSequence(snapshot.stack, [&]() {
+      return decoder.getValue();
+    });
+    decoder.getSequence(snapshot.callStack, [&]() {
+      return static_cast<std::size_t>(decoder.getVarint());
+    });
+    snapshot.global = decoder.getScope();
+    decoder.getSequence(snapshot.frames, [&]() {
+      return decoder.getScope();
+    });
+    decoder.getSequence(snapshot.arguments, [&]() {
+      unsigned char key = decoder.get<uint8_t>();
+      return std::make_pair(key, decoder.getValue());
+    });
+    return snapshot;
+  }
+}
\ No newline at end of file
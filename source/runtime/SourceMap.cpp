@@ -12,7 +12,9 @@
 */
 
 #include "gcodelib/runtime/SourceMap.h"
-#include <functional>
+#include "gcodelib/runtime/Error.h"
+#include <algorithm>
+#include <tuple>
 
 namespace GCodeLib::Runtime {
 
@@ -35,22 +37,155 @@ namespace GCodeLib::Runtime {
     return address >= this->start && address < this->start + this->length;
   }
 
+  IRSourceMap::IRSourceMap(const IRSourceMap &map)
+    : entries(map.entries), tags(map.tags), indexed(false) {}
+
+  IRSourceMap &IRSourceMap::operator=(const IRSourceMap &map) {
+    if (this != &map) {
+      std::lock_guard<std::mutex> lock(this->indexMutex);
+      this->entries = map.entries;
+      this->tags = map.tags;
+      this->runs.clear();
+      this->lines.clear();
+      this->indexed = false;
+    }
+    return *this;
+  }
+
   void IRSourceMap::addBlock(const Parser::SourcePosition &position, std::size_t start, std::size_t length) {
-    this->blocks.push_back(IRSourceBlock(position, start, length));
+    if (start > UINT32_MAX || length > UINT32_MAX - start) {
+      throw GCodeRuntimeError("Source block address is out of range");
+    }
+    std::lock_guard<std::mutex> lock(this->indexMutex);
+    this->entries.push_back(Entry {
+      static_cast<uint32_t>(start),
+      static_cast<uint32_t>(length),
+      position.getLine(),
+      this->getTagId(position.getTag()),
+      position.getColumn(),
+      position.getChecksum()
+    });
+    this->indexed = false;
+  }
+
+  std::optional<Parser::SourcePosition> IRSourceMap::locate(std::size_t address) const {
+    this->buildIndex();
+    auto run = std::upper_bound(this->runs.begin(), this->runs.end(), address, [](std::size_t addr, const Run &run) {
+      return addr < run.start;
+    });
+    if (run == this->runs.begin() || (--run)->entry == IRSourceMap::NoEntry) {
+      return std::optional<Parser::SourcePosition>();
+    } else {
+      return this->getPosition(this->entries[run->entry]);
+    }
   }
 
-  std::optional<Parser::SourcePosition> IRSourceMap::locate(std::size_t address) {
-    std::optional<std::reference_wrapper<const IRSourceBlock>> result;
-    for (const auto &block : this->blocks) {
-      if (block.includes(address) && (
-        !result.has_value() || result.value().get().getLength() > block.getLength())) {
-        result = std::ref(block);
+  std::optional<std::size_t> IRSourceMap::findAddress(uint32_t line) const {
+    std::optional<std::size_t> result;
+    for (std::size_t tag = 0; tag < this->tags.size(); tag++) {
+      auto address = this->findAddress(this->tags[tag], line);
+      if (address.has_value() && (!result.has_value() || address.value() < result.value())) {
+        result = address;
       }
     }
-    if (result.has_value()) {
-      return result.value().get().getSourcePosition();
+    return result;
+  }
+
+  std::optional<std::size_t> IRSourceMap::findAddress(const std::string &tag, uint32_t line) const {
+    this->buildIndex();
+    auto tagId = std::find(this->tags.begin(), this->tags.end(), tag);
+    if (tagId == this->tags.end()) {
+      return std::optional<std::size_t>();
+    }
+    LineAddress key { static_cast<uint32_t>(tagId - this->tags.begin()), line, 0 };
+    auto entry = std::lower_bound(this->lines.begin(), this->lines.end(), key, [](const LineAddress &a, const LineAddress &b) {
+      return std::tie(a.tag, a.line) < std::tie(b.tag, b.line);
+    });
+    if (entry != this->lines.end() && entry->tag == key.tag && entry->line == line) {
+      return entry->address;
     } else {
-      return std::optional<Parser::SourcePosition>();
+      return std::optional<std::size_t>();
+    }
+  }
+
+  std::size_t IRSourceMap::size() const {
+    return this->entries.size();
+  }
+
+  IRSourceBlock IRSourceMap::getBlock(std::size_t index) const {
+    const Entry &entry = this->entries.at(index);
+    return IRSourceBlock(this->getPosition(entry), entry.start, entry.length);
+  }
+
+  std::size_t IRSourceMap::getFootprint() const {
+    std::size_t footprint = this->entries.capacity() * sizeof(Entry) +
+      this->runs.capacity() * sizeof(Run) +
+      this->lines.capacity() * sizeof(LineAddress);
+    for (const auto &tag : this->tags) {
+      footprint += sizeof(std::string) + tag.capacity();
+    }
+    return footprint;
+  }
+
+  void IRSourceMap::buildIndex() const {
+    if (this->indexed.load(std::memory_order_acquire)) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(this->indexMutex);
+    if (this->indexed.load(std::memory_order_relaxed)) {
+      return;
+    }
+    uint32_t end = 0;
+    std::vector<uint32_t> order;
+    order.reserve(this->entries.size());
+    for (uint32_t i = 0; i < this->entries.size(); i++) {
+      end = std::max(end, this->entries[i].start + this->entries[i].length);
+      order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+      return this->entries[a].length > this->entries[b].length ||
+        (this->entries[a].length == this->entries[b].length && a > b);
+    });
+    std::vector<uint32_t> owners(end, IRSourceMap::NoEntry);
+    for (uint32_t index : order) {
+      const Entry &entry = this->entries[index];
+      std::fill(owners.begin() + entry.start, owners.begin() + entry.start + entry.length, index);
+    }
+
+    this->runs.clear();
+    this->lines.clear();
+    for (uint32_t address = 0; address < end; address++) {
+      if (this->runs.empty() || this->runs.back().entry != owners[address]) {
+        this->runs.push_back(Run { address, owners[address] });
+        if (owners[address] != IRSourceMap::NoEntry) {
+          const Entry &entry = this->entries[owners[address]];
+          this->lines.push_back(LineAddress { entry.tag, entry.line, address });
+        }
+      }
+    }
+    this->runs.push_back(Run { end, IRSourceMap::NoEntry });
+    this->runs.shrink_to_fit();
+    std::sort(this->lines.begin(), this->lines.end(), [](const LineAddress &a, const LineAddress &b) {
+      return std::tie(a.tag, a.line, a.address) < std::tie(b.tag, b.line, b.address);
+    });
+    this->lines.erase(std::unique(this->lines.begin(), this->lines.end(), [](const LineAddress &a, const LineAddress &b) {
+      return a.tag == b.tag && a.line == b.line;
+    }), this->lines.end());
+    this->lines.shrink_to_fit();
+    this->indexed.store(true, std::memory_order_release);
+  }
+
+  Parser::SourcePosition IRSourceMap::getPosition(const Entry &entry) const {
+    return Parser::SourcePosition(this->tags[entry.tag], entry.line, entry.column, entry.checksum);
+  }
+
+  uint32_t IRSourceMap::getTagId(const std::string &tag) {
+    for (std::size_t i = this->tags.size(); i > 0; i--) {
+      if (this->tags[i - 1] == tag) {
+        return static_cast<uint32_t>(i - 1);
+      }
     }
+    this->tags.push_back(tag);
+    return static_cast<uint32_t>(this->tags.size() - 1);
   }
 }
\ No newline at end of file
@@ -15,6 +15,244 @@
 
 namespace GCodeLib::Runtime {
 
+  GCodeLocalDictionary::GCodeLocalDictionary(GCodeDictionary<int64_t> *parent)
+    : parent(parent) {}
+
+  GCodeDictionary<int64_t> *GCodeLocalDictionary::getParent() {
+    return this->parent;
+  }
+
+  const GCodeDictionary<int64_t> *GCodeLocalDictionary::getParent() const {
+    return this->parent;
+  }
+
+  bool GCodeLocalDictionary::has(const int64_t &key) const {
+    return this->hasOwn(key) ||
+      (this->parent != nullptr && this->parent->has(key));
+  }
+
+  bool GCodeLocalDictionary::hasOwn(const int64_t &key) const {
+    if (isFixed(key)) {
+      return this->present.test(static_cast<std::size_t>(key));
+    } else {
+      return this->overflow.get().count(key) != 0;
+    }
+  }
+
+  GCodeRuntimeValue GCodeLocalDictionary::get(const int64_t &key) const {
+    if (isFixed(key) && this->present.test(static_cast<std::size_t>(key))) {
+      return this->fixed[static_cast<std::size_t>(key)];
+    } else if (!isFixed(key) && this->overflow.get().count(key) != 0) {
+      return this->overflow.get().at(key);
+    } else if (this->parent != nullptr) {
+      return this->parent->get(key);
+    } else {
+      return GCodeRuntimeValue::Empty;
+    }
+  }
+
+  bool GCodeLocalDictionary::put(const int64_t &key, const GCodeRuntimeValue &value) {
+    if (this->hasOwn(key) ||
+      this->parent == nullptr ||
+      !this->parent->has(key)) {
+      this->putOwn(key, value);
+      return true;
+    } else {
+      this->parent->put(key, value);
+      return false;
+    }
+  }
+
+  void GCodeLocalDictionary::putOwn(const int64_t &key, const GCodeRuntimeValue &value) {
+    if (isFixed(key)) {
+      this->fixed[static_cast<std::size_t>(key)] = value;
+      this->present.set(static_cast<std::size_t>(key));
+    } else {
+      this->overflow.mutate()[key] = value;
+    }
+  }
+
+  void GCodeLocalDictionary::copyOwn(const GCodeLocalDictionary &other) {
+    this->present = other.present;
+    this->fixed = other.fixed;
+    this->overflow = other.overflow;
+  }
+
+  void GCodeLocalDictionary::visitOwn(const std::function<void(int64_t, const GCodeRuntimeValue &)> &visitor) const {
+    for (std::size_t i = 0; i < FixedSlots; i++) {
+      if (this->present.test(i)) {
+        visitor(static_cast<int64_t>(i), this->fixed[i]);
+      }
+    }
+    for (const auto &entry : this->overflow.get()) {
+      visitor(entry.first, entry.second);
+    }
+  }
+
+  bool GCodeLocalDictionary::remove(const int64_t &key) {
+    if (isFixed(key) && this->present.test(static_cast<std::size_t>(key))) {
+      this->fixed[static_cast<std::size_t>(key)] = GCodeRuntimeValue::Empty;
+      this->present.reset(static_cast<std::size_t>(key));
+      return true;
+    } else if (!isFixed(key) && this->overflow.get().count(key) != 0) {
+      this->overflow.mutate().erase(key);
+      return true;
+    } else if (this->parent != nullptr) {
+      return this->parent->remove(key);
+    } else {
+      return false;
+    }
+  }
+
+  void GCodeLocalDictionary::clear() {
+    if (this->present.any()) {
+      for (std::size_t i = 0; i < FixedSlots; i++) {
+        if (this->present.test(i)) {
+          this->fixed[i] = GCodeRuntimeValue::Empty;
+        }
+      }
+      this->present.reset();
+    }
+    if (!this->overflow.get().empty()) {
+      this->overflow.reset();
+    }
+  }
+
+  GCodeDenseDictionary::GCodeDenseDictionary(GCodeDictionary<int64_t> *parent)
+    : parent(parent) {}
+
+  GCodeDictionary<int64_t> *GCodeDenseDictionary::getParent() {
+    return this->parent;
+  }
+
+  const GCodeDictionary<int64_t> *GCodeDenseDictionary::getParent() const {
+    return this->parent;
+  }
+
+  const GCodeRuntimeValue *GCodeDenseDictionary::find(int64_t key) const {
+    if (isDense(key)) {
+      std::size_t index = static_cast<std::size_t>(key);
+      const Chunk *chunk = this->chunks[index / ChunkSize].get();
+      if (chunk != nullptr && (chunk->present & (1ULL << (index % ChunkSize))) != 0) {
+        return &chunk->values[index % ChunkSize];
+      } else {
+        return nullptr;
+      }
+    } else {
+      auto it = this->sparse.get().find(key);
+      return it != this->sparse.get().end() ? &it->second : nullptr;
+    }
+  }
+
+  bool GCodeDenseDictionary::has(const int64_t &key) const {
+    return this->find(key) != nullptr ||
+      (this->parent != nullptr && this->parent->has(key));
+  }
+
+  bool GCodeDenseDictionary::hasOwn(const int64_t &key) const {
+    return this->find(key) != nullptr;
+  }
+
+  GCodeRuntimeValue GCodeDenseDictionary::get(const int64_t &key) const {
+    const GCodeRuntimeValue *value = this->find(key);
+    if (value != nullptr) {
+      return *value;
+    } else if (this->parent != nullptr) {
+      return this->parent->get(key);
+    } else {
+      return GCodeRuntimeValue::Empty;
+    }
+  }
+
+  bool GCodeDenseDictionary::put(const int64_t &key, const GCodeRuntimeValue &value) {
+    if (this->hasOwn(key) ||
+      this->parent == nullptr ||
+      !this->parent->has(key)) {
+      this->putOwn(key, value);
+      return true;
+    } else {
+      this->parent->put(key, value);
+      return false;
+    }
+  }
+
+  void GCodeDenseDictionary::putOwn(const int64_t &key, const GCodeRuntimeValue &value) {
+    if (isDense(key)) {
+      std::size_t index = static_cast<std::size_t>(key);
+      Chunk &chunk = this->mutableChunk(index / ChunkSize);
+      chunk.values[index % ChunkSize] = value;
+      chunk.present |= 1ULL << (index % ChunkSize);
+    } else {
+      this->sparse.mutate()[key] = value;
+    }
+  }
+
+  void GCodeDenseDictionary::copyOwn(const GCodeDenseDictionary &other) {
+    this->chunks = other.chunks;
+    this->sparse = other.sparse;
+  }
+
+  GCodeDenseDictionary::Chunk &GCodeDenseDictionary::mutableChunk(std::size_t index) {
+    std::shared_ptr<Chunk> &chunk = this->chunks[index];
+    if (chunk == nullptr) {
+      chunk = std::make_shared<Chunk>();
+    } else if (chunk.use_count() > 1) {
+      chunk = std::make_shared<Chunk>(*chunk);
+    }
+    return *chunk;
+  }
+
+  void GCodeDenseDictionary::visitOwn(const std::function<void(int64_t, const GCodeRuntimeValue &)> &visitor) const {
+    for (std::size_t c = 0; c < ChunkCount; c++) {
+      const Chunk *chunk = this->chunks[c].get();
+      if (chunk == nullptr || chunk->present == 0) {
+        continue;
+      }
+      for (std::size_t i = 0; i < ChunkSize; i++) {
+        if ((chunk->present & (1ULL << i)) != 0) {
+          visitor(static_cast<int64_t>(c * ChunkSize + i), chunk->values[i]);
+        }
+      }
+    }
+    for (const auto &entry : this->sparse.get()) {
+      visitor(entry.first, entry.second);
+    }
+  }
+
+  bool GCodeDenseDictionary::remove(const int64_t &key) {
+    if (this->hasOwn(key)) {
+      if (isDense(key)) {
+        std::size_t index = static_cast<std::size_t>(key);
+        Chunk &chunk = this->mutableChunk(index / ChunkSize);
+        chunk.values[index % ChunkSize] = GCodeRuntimeValue::Empty;
+        chunk.present &= ~(1ULL << (index % ChunkSize));
+      } else {
+        this->sparse.mutate().erase(key);
+      }
+      return true;
+    } else if (this->parent != nullptr) {
+      return this->parent->remove(key);
+    } else {
+      return false;
+    }
+  }
+
+  void GCodeDenseDictionary::clear() {
+    for (auto &chunk : this->chunks) {
+      if (chunk != nullptr && chunk.use_count() > 1) {
+        chunk.reset();
+      } else if (chunk != nullptr && chunk->present != 0) {
+        for (std::size_t i = 0; i < ChunkSize; i++) {
+          chunk->values[i] = GCodeRuntimeValue::Empty;
+        }
+        chunk->present = 0;
+      }
+    }
+    if (!this->sparse.get().empty()) {
+      this->sparse.reset();
+    }
+  }
+
   GCodeCascadeVariableScope::GCodeCascadeVariableScope(GCodeVariableScope *parent)
     : numbered(parent ? &parent->getNumbered() : nullptr),
       named(parent ? &parent->getNamed() : nullptr) {}
@@ -37,4 +275,49 @@ namespace GCodeLib::Runtime {
   GCodeDictionary<std::string> &GCodeCustomVariableScope::getNamed() {
     return this->named;
   }
+
+  GCodeDenseVariableScope::GCodeDenseVariableScope(GCodeVariableScope *parent)
+    : numbered(parent ? &parent->getNumbered() : nullptr),
+      named(parent ? &parent->getNamed() : nullptr) {}
+
+  GCodeDenseDictionary &GCodeDenseVariableScope::getNumbered() {
+    return this->numbered;
+  }
+
+  GCodeScopedDictionary<std::string> &GCodeDenseVariableScope::getNamed() {
+    return this->named;
+  }
+
+  const GCodeDenseDictionary &GCodeDenseVariableScope::getNumbered() const {
+    return this->numbered;
+  }
+
+  const GCodeScopedDictionary<std::string> &GCodeDenseVariableScope::getNamed() const {
+    return this->named;
+  }
+
+  GCodeFrameVariableScope::GCodeFrameVariableScope(GCodeVariableScope *parent)
+    : numbered(parent ? &parent->getNumbered() : nullptr),
+      named(parent ? &parent->getNamed() : nullptr) {}
+
+  GCodeLocalDictionary &GCodeFrameVariableScope::getNumbered() {
+    return this->numbered;
+  }
+
+  GCodeScopedDictionary<std::string> &GCodeFrameVariableScope::getNamed() {
+    return this->named;
+  }
+
+  const GCodeLocalDictionary &GCodeFrameVariableScope::getNumbered() const {
+    return this->numbered;
+  }
+
+  const GCodeScopedDictionary<std::string> &GCodeFrameVariableScope::getNamed() const {
+    return this->named;
+  }
+
+  void GCodeFrameVariableScope::reset() {
+    this->numbered.clear();
+    this->named.clear();
+  }
 }
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "gcodelib/runtime/Syscall.h"
+
+namespace GCodeLib::Runtime {
+
+  GCodeSyscallArguments::GCodeSyscallArguments()
+    : mask(0), values{} {}
+
+  void GCodeSyscallArguments::clear() {
+    this->mask = 0;
+  }
+
+  bool GCodeSyscallArguments::put(unsigned char key, const GCodeRuntimeValue &value) {
+    if (isArgument(key)) {
+      this->mask |= bit(key);
+      this->values[key - 'A'] = value.asFloat();
+      this->raw[key - 'A'] = value;
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  void GCodeSyscallArguments::copyTo(GCodeDictionary<unsigned char> &dictionary) const {
+    for (unsigned char key = 'A'; key <= 'Z'; key++) {
+      if (this->has(key)) {
+        dictionary.put(key, this->raw[key - 'A']);
+      }
+    }
+  }
+}
\ No newline at end of file
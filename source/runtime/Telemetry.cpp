@@ -0,0 +1,79 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "gcodelib/runtime/Telemetry.h"
+#include <thread>
+
+namespace GCodeLib::Runtime {
+
+  GCodeTelemetry::GCodeTelemetry(const GCodeIRModule &module)
+    : module(module), instructions(0), commands(0), address(0), depth(0), running(false) {}
+
+  const GCodeIRModule &GCodeTelemetry::getModule() const {
+    return this->module;
+  }
+
+  GCodeTelemetrySnapshot GCodeTelemetry::read() const {
+    GCodeTelemetrySnapshot snapshot;
+    while (true) {
+      uint32_t sequence = this->block.sequence.load(std::memory_order_acquire);
+      if (sequence & 1) {
+        std::this_thread::yield();
+        continue;
+      }
+      snapshot.instructions = this->block.instructions.load(std::memory_order_relaxed);
+      snapshot.commands = this->block.commands.load(std::memory_order_relaxed);
+      snapshot.address = this->block.address.load(std::memory_order_relaxed);
+      snapshot.callDepth = this->block.depth.load(std::memory_order_relaxed);
+      snapshot.running = this->block.running.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (this->block.sequence.load(std::memory_order_relaxed) == sequence) {
+        break;
+      }
+    }
+    if (snapshot.commands > 0) {
+      snapshot.position = this->module.getSourceMap().locate(snapshot.address);
+    }
+    return snapshot;
+  }
+
+  uint64_t GCodeTelemetry::getInstructions() const {
+    return this->block.instructions.load(std::memory_order_relaxed);
+  }
+
+  uint64_t GCodeTelemetry::getCommands() const {
+    return this->block.commands.load(std::memory_order_relaxed);
+  }
+
+  void GCodeTelemetry::resume() {
+    this->running = true;
+    this->publish();
+  }
+
+  void GCodeTelemetry::suspend() {
+    this->running = false;
+    this->publish();
+  }
+
+  void GCodeTelemetry::publish() {
+    uint32_t sequence = this->block.sequence.load(std::memory_order_relaxed);
+    this->block.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    this->block.instructions.store(this->instructions, std::memory_order_relaxed);
+    this->block.commands.store(this->commands, std::memory_order_relaxed);
+    this->block.address.store(this->address, std::memory_order_relaxed);
+    this->block.depth.store(this->depth, std::memory_order_relaxed);
+    this->block.running.store(this->running, std::memory_order_relaxed);
+    this->block.sequence.store(sequence + 2, std::memory_order_release);
+  }
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "gcodelib/runtime/Threaded.h"
+
+namespace GCodeLib::Runtime {
+
+  GCodeThreadedRunner::GCodeThreadedRunner(GCodeInterpreter &interpreter, std::size_t queueCapacity, std::size_t batchSize)
+    : interpreter(interpreter), queue(queueCapacity), batch(batchSize > 0 ? batchSize : 1), cancelled(false), running(false),
+      published(0), popped(0), applied(0), producerWaiting(false), consumerWaiting(false) {}
+
+  GCodeThreadedRunner::~GCodeThreadedRunner() {
+    this->stop();
+  }
+
+  void GCodeThreadedRunner::start() {
+    if (this->worker.joinable()) {
+      throw GCodeRuntimeError("Threaded runner is already started");
+    }
+    this->cancelled = false;
+    this->running = true;
+    this->published = 0;
+    this->popped = 0;
+    this->applied = 0;
+    this->worker = std::thread([this]() {
+      this->run();
+    });
+  }
+
+  void GCodeThreadedRunner::stop() {
+    this->cancelled = true;
+    this->wake(this->producerSignal, this->producerWaiting);
+    if (this->worker.joinable()) {
+      this->worker.join();
+    }
+    GCodeQueuedCommand command;
+    while (this->queue.tryPop(command)) {}
+    this->running = false;
+  }
+
+  bool GCodeThreadedRunner::isRunning() const {
+    return this->running;
+  }
+
+  bool GCodeThreadedRunner::tryPop(GCodeQueuedCommand &command) {
+    this->applied.store(this->popped, std::memory_order_release);
+    bool received = this->queue.tryPop(command);
+    if (received) {
+      this->popped++;
+    }
+    this->wake(this->producerSignal, this->producerWaiting);
+    return received;
+  }
+
+  GCodeQueuedCommand GCodeThreadedRunner::pop() {
+    if (!this->worker.joinable()) {
+      throw GCodeRuntimeError("Threaded runner is not started");
+    }
+    GCodeQueuedCommand command;
+    while (!this->tryPop(command)) {
+      if (!this->running && this->queue.empty()) {
+        throw GCodeRuntimeError("Command queue is exhausted");
+      }
+      this->wait(this->consumerSignal, this->consumerWaiting, [this]() {
+        return !this->queue.empty() || !this->running;
+      });
+    }
+    return command;
+  }
+
+  void GCodeThreadedRunner::complete() {
+    this->applied.store(this->popped, std::memory_order_release);
+    this->wake(this->producerSignal, this->producerWaiting);
+  }
+
+  bool GCodeThreadedRunner::publish(const GCodeQueuedCommand &command) {
+    while (!this->queue.tryPush(command)) {
+      if (this->cancelled) {
+        return false;
+      }
+      this->wait(this->producerSignal, this->producerWaiting, [this]() {
+        return this->queue.size() < this->queue.capacity();
+      });
+    }
+    this->published++;
+    this->wake(this->consumerSignal, this->consumerWaiting);
+    return true;
+  }
+
+  // Lock-free on both sides unless the peer sleeps: the waiter raises its flag before re-checking,
+  // the waker publishes before reading the flag, and the fences keep either from missing the other.
+  template <typename Predicate>
+  void GCodeThreadedRunner::wait(std::condition_variable &signal, std::atomic<bool> &waiting, Predicate predicate) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    waiting = true;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    signal.wait(lock, [&]() {
+      return this->cancelled || predicate();
+    });
+    waiting = false;
+  }
+
+  void GCodeThreadedRunner::wake(std::condition_variable &signal, std::atomic<bool> &waiting) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting) {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      signal.notify_all();
+    }
+  }
+
+  void GCodeThreadedRunner::run() {
+    GCodeQueuedCommand command;
+    try {
+      this->interpreter.start();
+      command.type = GCodeQueuedCommand::Type::Command;
+      while (!this->cancelled && !this->interpreter.isFinished()) {
+        // Unacknowledged commands may still be writing the system scope, so the batch must not probe it
+        GCodeSystemScopeAccess access = this->applied.load(std::memory_order_acquire) == this->published
+          ? GCodeSystemScopeAccess::Synchronized : GCodeSystemScopeAccess::Unsynchronized;
+        GCodeCommandSpan span = this->interpreter.executeBatch(this->batch.data(), this->batch.size(), GCodeInterpreter::Unbounded, access);
+        for (const auto &record : span) {
+          command.command = record;
+          if (!this->publish(command)) {
+            break;
+          }
+        }
+        if (span.size() < this->batch.size() && !this->interpreter.isFinished()) {
+          this->wait(this->producerSignal, this->producerWaiting, [this]() {
+            return this->applied.load(std::memory_order_acquire) == this->published;
+          });
+        }
+      }
+      command.type = GCodeQueuedCommand::Type::Finished;
+    } catch (const GCodeRuntimeError &ex) {
+      command.type = GCodeQueuedCommand::Type::Error;
+      command.error = ex;
+    } catch (const std::exception &ex) {
+      command.type = GCodeQueuedCommand::Type::Error;
+      command.error = GCodeRuntimeError(ex.what());
+    }
+    this->publish(command);
+    this->running = false;
+    this->wake(this->consumerSignal, this->consumerWaiting);
+  }
+}
\ No newline at end of file
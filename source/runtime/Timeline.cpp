@@ -0,0 +1,94 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+#include "gcodelib/runtime/Timeline.h"
+#include "gcodelib/runtime/Error.h"
+
+namespace GCodeLib::Runtime {
+
+  GCodeTimelineTracer::GCodeTimelineTracer(const GCodeIRModule &module, GCodeTimelineSink &sink, std::size_t sampleInterval, std::size_t batchSize)
+    : module(module), sink(sink), sampleInterval(sampleInterval), batchSize(batchSize),
+      calls(0), sampledCalls(0), syscalls(0), batched(0), thread(0) {
+    if (sampleInterval == 0) {
+      throw GCodeRuntimeError("Call sample interval must be positive");
+    }
+    if (batchSize == 0) {
+      throw GCodeRuntimeError("Syscall batch size must be positive");
+    }
+  }
+
+  const GCodeIRModule &GCodeTimelineTracer::getModule() const {
+    return this->module;
+  }
+
+  GCodeTimelineSink &GCodeTimelineTracer::getSink() const {
+    return this->sink;
+  }
+
+  uint64_t GCodeTimelineTracer::getCalls() const {
+    return this->calls;
+  }
+
+  uint64_t GCodeTimelineTracer::getSampledCalls() const {
+    return this->sampledCalls;
+  }
+
+  uint64_t GCodeTimelineTracer::getSyscalls() const {
+    return this->syscalls;
+  }
+
+  void GCodeTimelineTracer::call(std::size_t address, int64_t procedure, std::size_t) {
+    bool sampled = this->calls++ % this->sampleInterval == 0;
+    if (sampled) {
+      // Batches are closed at sampled call boundaries to keep spans properly nested
+      this->flush();
+      this->sampledCalls++;
+      this->frames.push_back(Frame { procedure, address, true, this->thread, Clock::now() });
+    } else {
+      this->frames.push_back(Frame { procedure, address, false, this->thread, Clock::time_point{} });
+    }
+  }
+
+  void GCodeTimelineTracer::ret(std::size_t, std::size_t) {
+    if (this->frames.empty()) {
+      return;
+    }
+    Frame frame = this->frames.back();
+    this->frames.pop_back();
+    if (frame.sampled) {
+      this->flush();
+      std::vector<std::pair<const char *, uint64_t>> args { { "depth", this->frames.size() } };
+      auto position = this->module.getSourceMap().locate(frame.address);
+      if (position.has_value()) {
+        args.emplace_back("line", position.value().getLine());
+      }
+      this->sink.record(GCodeTimelineSpan { "o" + std::to_string(frame.procedure), "call", frame.begin,
+        Clock::now() - frame.begin, frame.thread, std::move(args) });
+    }
+  }
+
+  void GCodeTimelineTracer::resume() {
+    this->thread = GCodeTimelineSink::currentThread();
+  }
+
+  void GCodeTimelineTracer::suspend() {
+    this->flush();
+  }
+
+  void GCodeTimelineTracer::flush() {
+    if (this->batched > 0) {
+      this->sink.record(GCodeTimelineSpan { "syscalls", "syscall", this->batchStart, Clock::now() - this->batchStart,
+        this->thread, { { "count", this->batched } } });
+      this->batched = 0;
+    }
+  }
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "gcodelib/runtime/Trace.h"
+#include "gcodelib/runtime/Error.h"
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace GCodeLib::Runtime {
+
+  static_assert(sizeof(GCodeTraceEvent) == 32);
+
+  GCodeRingBufferTracer::GCodeRingBufferTracer(std::size_t capacity, uint32_t filter)
+    : GCodeEventTracer<GCodeRingBufferTracer>(filter), recorded(0) {
+    std::size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    this->events.resize(size);
+    this->mask = size - 1;
+  }
+
+  std::size_t GCodeRingBufferTracer::getCapacity() const {
+    return this->events.size();
+  }
+
+  uint64_t GCodeRingBufferTracer::getRecorded() const {
+    return this->recorded;
+  }
+
+  std::vector<GCodeTraceEvent> GCodeRingBufferTracer::getEvents() const {
+    std::vector<GCodeTraceEvent> events;
+    uint64_t first = this->recorded > this->events.size() ? this->recorded - this->events.size() : 0;
+    for (uint64_t index = first; index < this->recorded; index++) {
+      events.push_back(this->events[index & this->mask]);
+    }
+    return events;
+  }
+
+  void GCodeRingBufferTracer::clear() {
+    this->recorded = 0;
+  }
+
+  GCodeFileTracer::GCodeFileTracer(std::ostream &os, uint32_t filter, std::size_t bufferSize)
+    : GCodeEventTracer<GCodeFileTracer>(filter), os(os), bufferSize(bufferSize > 0 ? bufferSize : 1), recorded(0) {
+    this->buffer.reserve(this->bufferSize);
+    uint16_t version = GCodeFileTracer::Version;
+    uint16_t eventSize = sizeof(GCodeTraceEvent);
+    this->os.write(GCodeFileTracer::Magic, sizeof(GCodeFileTracer::Magic));
+    this->os.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    this->os.write(reinterpret_cast<const char *>(&eventSize), sizeof(eventSize));
+  }
+
+  GCodeFileTracer::~GCodeFileTracer() {
+    try {
+      this->flush();
+    } catch (...) {}
+  }
+
+  void GCodeFileTracer::suspend() {
+    this->flush();
+  }
+
+  void GCodeFileTracer::flush() {
+    if (this->buffer.empty()) {
+      return;
+    }
+    this->os.write(reinterpret_cast<const char *>(this->buffer.data()), this->buffer.size() * sizeof(GCodeTraceEvent));
+    this->recorded += this->buffer.size();
+    this->buffer.clear();
+    if (!this->os) {
+      throw GCodeRuntimeError("Unable to write trace events");
+    }
+  }
+
+  uint64_t GCodeFileTracer::getRecorded() const {
+    return this->recorded + this->buffer.size();
+  }
+
+  std::vector<GCodeTraceEvent> GCodeFileTracer::read(std::istream &is) {
+    char magic[sizeof(GCodeFileTracer::Magic)];
+    uint16_t version, eventSize;
+    if (!is.read(magic, sizeof(magic)) ||
+      !is.read(reinterpret_cast<char *>(&version), sizeof(version)) ||
+      !is.read(reinterpret_cast<char *>(&eventSize), sizeof(eventSize))) {
+      throw GCodeRuntimeError("Malformed trace: unexpected end of stream");
+    }
+    if (std::memcmp(magic, GCodeFileTracer::Magic, sizeof(magic)) != 0) {
+      throw GCodeRuntimeError("Malformed trace: bad magic");
+    }
+    if (version != GCodeFileTracer::Version || eventSize != sizeof(GCodeTraceEvent)) {
+      throw GCodeRuntimeError("Unsupported trace version");
+    }
+    std::vector<GCodeTraceEvent> events;
+    GCodeTraceEvent event;
+    while (is.read(reinterpret_cast<char *>(&event), sizeof(event))) {
+      events.push_back(event);
+    }
+    if (is.gcount() != 0) {
+      throw GCodeRuntimeError("Malformed trace: truncated event");
+    }
+    return events;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "gcodelib/DiskCache.h"
+#include "catch.hpp"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace GCodeLib;
+
+static std::string dump(const Runtime::GCodeIRModule &module) {
+  std::stringstream ss;
+  ss << module;
+  return ss.str();
+}
+
+static void write_file(const std::filesystem::path &path, const std::string &content) {
+  std::ofstream os(path, std::ios::binary | std::ios::trunc);
+  os << content;
+}
+
+TEST_CASE("Disk cache") {
+  std::random_device random;
+  std::filesystem::path root = std::filesystem::temp_directory_path() / ("gcodelib-cache-" + std::to_string(random()));
+  std::filesystem::path cacheDir = root / "cache";
+  std::filesystem::create_directories(root);
+  std::filesystem::path program = root / "program.ngc";
+  std::filesystem::path subroutine = root / "sub.ngc";
+  write_file(program, "G1 X1 Y2\nG1 X3 Y4\n");
+  write_file(subroutine, "o100 sub\nG0 Z1\no100 endsub\n");
+  GCodeLinuxCNC compiler;
+  std::vector<std::string> dependencies { subroutine.string() };
+
+  SECTION("Hits across instances") {
+    GCodeDiskCache cache(cacheDir.string());
+    auto compiled = cache.compileFile(compiler, program.string(), dependencies);
+    REQUIRE(cache.getStatistics().misses == 1);
+    REQUIRE(cache.getStatistics().writes == 1);
+    auto cached = cache.compileFile(compiler, program.string(), dependencies);
+    REQUIRE(cache.getStatistics().hits == 1);
+    REQUIRE(dump(*cached) == dump(*compiled));
+    REQUIRE(cached->isFrozen());
+    GCodeDiskCache other(cacheDir.string());
+    REQUIRE(dump(*other.compileFile(compiler, program.string(), dependencies)) == dump(*compiled));
+    REQUIRE(other.getStatistics().hits == 1);
+    GCodeRepRap reprap;
+    other.compileFile(reprap, program.string(), dependencies);
+    REQUIRE(other.getStatistics().misses == 1);
+  }
+  SECTION("Invalidation") {
+    GCodeDiskCache cache(cacheDir.string());
+    cache.compileFile(compiler, program.string(), dependencies);
+    write_file(subroutine, "o100 sub\nG0 Z2\no100 endsub\n");
+    cache.compileFile(compiler, program.string(), dependencies);
+    REQUIRE(cache.getStatistics().invalidations == 1);
+    REQUIRE(cache.getStatistics().misses == 2);
+    cache.compileFile(compiler, program.string(), dependencies);
+    REQUIRE(cache.getStatistics().hits == 1);
+    write_file(program, "G1 X5 Y6\n");
+    auto updated = cache.compileFile(compiler, program.string(), dependencies);
+    REQUIRE(cache.getStatistics().misses == 3);
+    REQUIRE(updated->at(1).getValue().getInteger() == 5);
+  }
+  SECTION("Corrupted entries") {
+    GCodeDiskCache cache(cacheDir.string());
+    auto compiled = cache.compileFile(compiler, program.string());
+    for (const auto &entry : std::filesystem::directory_iterator(cacheDir)) {
+      std::string content;
+      {
+        std::ifstream is(entry.path(), std::ios::binary);
+        std::stringstream ss;
+        ss << is.rdbuf();
+        content = ss.str();
+      }
+      content[content.size() - 1] ^= 0x55;
+      write_file(entry.path(), content);
+    }
+    auto recompiled = cache.compileFile(compiler, program.string());
+    REQUIRE(cache.getStatistics().invalidations == 1);
+    REQUIRE(dump(*recompiled) == dump(*compiled));
+    cache.compileFile(compiler, program.string());
+    REQUIRE(cache.getStatistics().hits == 1);
+  }
+  SECTION("Malformed manifests") {
+    GCodeDiskCache cache(cacheDir.string());
+    auto compiled = cache.compileFile(compiler, program.string());
+    std::filesystem::path entry = std::filesystem::directory_iterator(cacheDir)->path();
+    std::string content;
+    {
+      std::ifstream is(entry, std::ios::binary);
+      std::stringstream ss;
+      ss << is.rdbuf();
+      content = ss.str();
+    }
+    // Same length, different program text: what a hash collision would look like
+    std::string collision = content;
+    collision.replace(collision.find("X1 Y2"), 5, "X7 Y8");
+    write_file(entry, collision);
+    REQUIRE(dump(*cache.compileFile(compiler, program.string())) == dump(*compiled));
+    REQUIRE(cache.getStatistics().invalidations == 1);
+    std::string oversized = content;
+    oversized.replace(oversized.find('\n') + 1, 2, "99999999999999999");
+    write_file(entry, oversized);
+    REQUIRE_NOTHROW(cache.compileFile(compiler, program.string()));
+    REQUIRE(cache.getStatistics().invalidations == 2);
+    cache.compileFile(compiler, program.string());
+    REQUIRE(cache.getStatistics().hits == 1);
+  }
+  SECTION("Missing files") {
+    GCodeDiskCache cache(cacheDir.string());
+    REQUIRE_THROWS(cache.compileFile(compiler, (root / "missing.ngc").string()));
+    REQUIRE_THROWS(cache.compileFile(compiler, program.string(), { (root / "missing.ngc").string() }));
+  }
+  std::filesystem::remove_all(root);
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "gcodelib/ModuleCache.h"
+#include "catch.hpp"
+#include <sstream>
+#include <thread>
+
+using namespace GCodeLib;
+
+static const std::string ProgramA = "G1 X1 Y2 F100\nG1 X3 Y4\n";
+static const std::string ProgramB = "G0 Z5\n";
+static const std::string ProgramC = "M104 S200\n";
+
+TEST_CASE("Module cache") {
+  GCodeRepRap reprap;
+  SECTION("Hits and misses") {
+    GCodeModuleCache cache;
+    auto first = cache.compile(reprap, ProgramA);
+    auto second = cache.compile(reprap, ProgramA);
+    REQUIRE(first == second);
+    REQUIRE(first->isFrozen());
+    std::stringstream ss(ProgramA);
+    REQUIRE(cache.compile(reprap, ss) == first);
+    REQUIRE(cache.compile(reprap, ProgramA, "other") != first);
+    GCodeLinuxCNC linuxcnc;
+    REQUIRE(cache.compile(linuxcnc, ProgramA) != first);
+    GCodeModuleCacheStatistics stats = cache.getStatistics();
+    REQUIRE(stats.hits == 2);
+    REQUIRE(stats.misses == 3);
+    REQUIRE(stats.entries == 3);
+    REQUIRE(stats.evictions == 0);
+    REQUIRE(stats.footprint > 0);
+    cache.clear();
+    REQUIRE(cache.getStatistics().entries == 0);
+    REQUIRE(cache.getStatistics().footprint == 0);
+    REQUIRE(cache.compile(reprap, ProgramA) != first);
+  }
+  SECTION("LRU eviction") {
+    GCodeModuleCache cache(2);
+    auto a = cache.compile(reprap, ProgramA);
+    cache.compile(reprap, ProgramB);
+    REQUIRE(cache.compile(reprap, ProgramA) == a);
+    cache.compile(reprap, ProgramC);
+    GCodeModuleCacheStatistics stats = cache.getStatistics();
+    REQUIRE(stats.entries == 2);
+    REQUIRE(stats.evictions == 1);
+    REQUIRE(cache.compile(reprap, ProgramA) == a);
+    cache.compile(reprap, ProgramB);
+    REQUIRE(cache.getStatistics().misses == 4);
+  }
+  SECTION("Memory bound") {
+    std::stringstream ss(ProgramA);
+    auto module = reprap.compile(ss, "");
+    GCodeModuleCache cache(GCodeModuleCache::DefaultCapacity, module->getFootprint() + 1);
+    cache.compile(reprap, ProgramA);
+    cache.compile(reprap, ProgramB);
+    GCodeModuleCacheStatistics stats = cache.getStatistics();
+    REQUIRE(stats.entries == 1);
+    REQUIRE(stats.evictions == 1);
+    REQUIRE(stats.footprint <= module->getFootprint() + 1);
+  }
+  SECTION("Compilation errors") {
+    GCodeModuleCache cache;
+    GCodeLinuxCNC linuxcnc;
+    REQUIRE_THROWS(cache.compile(linuxcnc, "G1 X[1 +\n"));
+    REQUIRE_THROWS(cache.compile(linuxcnc, "G1 X[1 +\n"));
+    REQUIRE(cache.getStatistics().misses == 2);
+    REQUIRE(cache.getStatistics().entries == 0);
+  }
+  SECTION("Single-flight compilation") {
+    constexpr std::size_t Threads = 8;
+    std::string program;
+    for (int i = 0; i < 2000; i++) {
+      program += "G1 X" + std::to_string(i) + " Y" + std::to_string(i * 2) + "\n";
+    }
+    GCodeModuleCache cache;
+    std::vector<GCodeModuleCache::ModulePtr> modules(Threads);
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < Threads; i++) {
+      workers.emplace_back([&, i]() {
+        GCodeRepRap frontend;
+        modules[i] = cache.compile(frontend, program);
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    for (const auto &module : modules) {
+      REQUIRE(module == modules[0]);
+    }
+    REQUIRE(cache.getStatistics().misses == 1);
+    REQUIRE(cache.getStatistics().hits == Threads - 1);
+  }
+  SECTION("Shared frontend") {
+    constexpr std::size_t Threads = 8;
+    GCodeModuleCache cache;
+    GCodeLinuxCNC shared;
+    std::vector<std::string> programs;
+    std::vector<std::size_t> lengths;
+    for (std::size_t i = 0; i < Threads; i++) {
+      std::string program = "o" + std::to_string(100 + i) + " sub\nG1 X#1\no" + std::to_string(100 + i) + " endsub\n";
+      for (std::size_t j = 0; j <= i * 100; j++) {
+        program += "o" + std::to_string(100 + i) + " call [" + std::to_string(j) + "]\n";
+      }
+      GCodeLinuxCNC reference;
+      std::stringstream ss(program);
+      lengths.push_back(reference.compile(ss, "")->length());
+      programs.push_back(std::move(program));
+    }
+    std::vector<GCodeModuleCache::ModulePtr> modules(Threads);
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < Threads; i++) {
+      workers.emplace_back([&, i]() {
+        modules[i] = cache.compile(shared, programs[i]);
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    for (std::size_t i = 0; i < Threads; i++) {
+      REQUIRE(modules[i]->length() == lengths[i]);
+    }
+    REQUIRE(cache.getStatistics().misses == Threads);
+  }
+}
\ No newline at end of file
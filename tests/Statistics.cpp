@@ -0,0 +1,87 @@
+#include "gcodelib/Frontend.h"
+#include "catch.hpp"
+#include <sstream>
+
+using namespace GCodeLib;
+
+TEST_CASE("Compiler statistics") {
+  SECTION("Frontend phases") {
+    GCodeRepRap reprap;
+    std::stringstream program("G1 X1 Y2\nG0 Z5\n");
+    GCodeCompilerStatistics stats;
+    auto module = reprap.compile(program, "test", stats);
+    std::stringstream source("G1 X1 Y2\nG0 Z5\n");
+    Parser::RepRap::GCodeDefaultScanner scanner(source);
+    std::size_t tokens = 0;
+    while (scanner.next().has_value()) {
+      tokens++;
+    }
+    REQUIRE(stats.tokens == tokens);
+    REQUIRE(stats.nodes == 13);
+    REQUIRE(stats.instructions == module->length());
+    REQUIRE(stats.sourceMapBlocks == module->getSourceMap().size());
+    REQUIRE(stats.sourceMapBytes == module->getSourceMap().getFootprint());
+    REQUIRE(stats.moduleBytes + stats.sourceMapBytes == module->getFootprint());
+    REQUIRE(stats.getTotalTime() == stats.scan + stats.parse + stats.validate + stats.translate);
+    REQUIRE(stats.validate.count() == 0);
+    REQUIRE(stats.scanMemory.allocations > 0);
+    REQUIRE(stats.parseMemory.allocations > 0);
+    REQUIRE(stats.validateMemory.allocations == 0);
+    REQUIRE(stats.translateMemory.allocations > 0);
+    REQUIRE(stats.allocations >= stats.scanMemory.allocations + stats.parseMemory.allocations + stats.translateMemory.allocations);
+    REQUIRE(stats.peakBytes > 0);
+    std::stringstream report;
+    report << stats;
+    REQUIRE(report.str().find("13 nodes") != std::string::npos);
+  }
+  SECTION("Expression nodes") {
+    GCodeLinuxCNC linuxcnc;
+    std::stringstream program("#1 = [1 + 2 * -#2]\n");
+    GCodeCompilerStatistics stats;
+    linuxcnc.compile(program, "", stats);
+    REQUIRE(stats.nodes == 8);
+    REQUIRE(stats.tokens > 0);
+  }
+  SECTION("Uninstrumented frontends") {
+    class PlainFrontend : public GCodeCompilerFrontend {
+     public:
+      std::unique_ptr<Parser::GCodeBlock> parse(std::istream &is, const std::string &tag) override {
+        return this->reprap.parse(is, tag);
+      }
+
+      std::unique_ptr<Runtime::GCodeIRModule> compile(std::istream &is, const std::string &tag) override {
+        return this->reprap.compile(is, tag);
+      }
+     private:
+      GCodeRepRap reprap;
+    };
+    PlainFrontend frontend;
+    GCodeCompilerFrontend &base = frontend;
+    std::stringstream program("G1 X1 Y2\n");
+    GCodeCompilerStatistics stats;
+    stats.tokens = 1;
+    auto module = base.compile(program, "", stats);
+    REQUIRE(module->length() > 0);
+    REQUIRE(stats.tokens == 0);
+    REQUIRE(stats.instructions == 0);
+  }
+  SECTION("Allocation counters") {
+    GCodeAllocationCounter::allocate(100);
+    GCodeAllocationCounter outer;
+    GCodeAllocationCounter::allocate(64);
+    {
+      GCodeAllocationCounter inner;
+      GCodeAllocationCounter::allocate(32);
+      GCodeAllocationCounter::deallocate(32);
+      GCodeAllocationCounter::allocate(16);
+      GCodeAllocationCounter::deallocate(100);
+      REQUIRE(inner.getAllocations() == 2);
+      REQUIRE(inner.getAllocatedBytes() == 48);
+      REQUIRE(inner.getPeakBytes() == 32);
+    }
+    GCodeAllocationCounter::allocate(8);
+    REQUIRE(outer.getAllocations() == 4);
+    REQUIRE(outer.getAllocatedBytes() == 120);
+    REQUIRE(outer.getPeakBytes() == 96);
+  }
+}
\ No newline at end of file
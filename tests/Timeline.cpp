@@ -0,0 +1,165 @@
+#include "gcodelib/Frontend.h"
+#include "gcodelib/runtime/Interpreter.h"
+#include "catch.hpp"
+#include <sstream>
+#include <thread>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+class GCodeCollectingSink : public GCodeTimelineSink {
+ public:
+  void record(const GCodeTimelineSpan &span) override {
+    this->spans.push_back(span);
+  }
+
+  std::vector<GCodeTimelineSpan> spans;
+};
+
+class GCodeTimelineInterpreter : public GCodeInterpreter {
+ public:
+  using GCodeInterpreter::GCodeInterpreter;
+
+  GCodeVariableScope &getSystemScope() override {
+    return this->scope;
+  }
+ protected:
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &) override {}
+ private:
+  GCodeCascadeVariableScope scope;
+};
+
+static const GCodeTimelineSpan *find_span(const std::vector<GCodeTimelineSpan> &spans, const std::string &name) {
+  for (const auto &span : spans) {
+    if (span.name == name) {
+      return &span;
+    }
+  }
+  return nullptr;
+}
+
+static uint64_t get_arg(const GCodeTimelineSpan &span, const std::string &key) {
+  for (const auto &arg : span.args) {
+    if (key == arg.first) {
+      return arg.second;
+    }
+  }
+  return 0;
+}
+
+TEST_CASE("Timeline") {
+  GCodeCollectingSink sink;
+  SECTION("Compile phases") {
+    GCodeLinuxCNC linuxcnc;
+    REQUIRE(linuxcnc.getTimeline() == nullptr);
+    std::stringstream untraced("G1 X1\n");
+    linuxcnc.compile(untraced, "untraced");
+    REQUIRE(sink.spans.empty());
+    linuxcnc.setTimeline(&sink);
+    REQUIRE(linuxcnc.getTimeline() == &sink);
+    std::stringstream program("#1 = [1 + 2]\nG1 X#1\n");
+    auto module = linuxcnc.compile(program, "program");
+    REQUIRE(sink.spans.size() == 5);
+    const GCodeTimelineSpan *compile = find_span(sink.spans, "compile program");
+    REQUIRE(compile != nullptr);
+    for (const char *phase : { "scan", "parse", "validate", "translate" }) {
+      const GCodeTimelineSpan *span = find_span(sink.spans, phase);
+      REQUIRE(span != nullptr);
+      REQUIRE(std::string(span->category) == "compile");
+      REQUIRE(span->thread == GCodeTimelineSink::currentThread());
+      REQUIRE(span->begin >= compile->begin);
+      REQUIRE(span->begin + span->duration <= compile->begin + compile->duration);
+    }
+    REQUIRE(get_arg(*find_span(sink.spans, "scan"), "tokens") > 0);
+    REQUIRE(get_arg(*find_span(sink.spans, "translate"), "instructions") == module->length());
+    GCodeRepRap reprap;
+    reprap.setTimeline(&sink);
+    std::stringstream reprapProgram("G1 X1\n");
+    reprap.compile(reprapProgram, "");
+    REQUIRE(sink.spans.size() == 9);
+    REQUIRE(find_span(sink.spans, "compile") != nullptr);
+  }
+  SECTION("Execution spans") {
+    GCodeLinuxCNC linuxcnc;
+    std::stringstream program(
+      "o100 sub\n"
+      "G1 X#0\n"
+      "G1 Y#0\n"
+      "G1 Z#0\n"
+      "o100 endsub\n"
+      "o101 repeat [4]\n"
+      "o100 call [1]\n"
+      "o101 endrepeat\n"
+      "G0 X0\n");
+    auto module = linuxcnc.compile(program, "program");
+    GCodeTimelineInterpreter interp(*module);
+    GCodeTimelineTracer timeline(*module, sink, 2, 2);
+    interp.setTimeline(&timeline);
+    REQUIRE(interp.getTimeline() == &timeline);
+    interp.execute();
+    REQUIRE(timeline.getCalls() == 4);
+    REQUIRE(timeline.getSampledCalls() == 2);
+    REQUIRE(timeline.getSyscalls() == 13);
+    std::size_t calls = 0;
+    uint64_t syscalls = 0;
+    for (const auto &span : sink.spans) {
+      REQUIRE(span.thread == GCodeTimelineSink::currentThread());
+      if (std::string(span.category) == "call") {
+        calls++;
+        REQUIRE(span.name == "o100");
+        REQUIRE(get_arg(span, "depth") == 0);
+        REQUIRE(get_arg(span, "line") == 7);
+      } else {
+        REQUIRE(span.name == "syscalls");
+        REQUIRE(get_arg(span, "count") <= 2);
+        syscalls += get_arg(span, "count");
+      }
+    }
+    REQUIRE(calls == 2);
+    REQUIRE(syscalls == 13);
+    for (const auto &outer : sink.spans) {
+      for (const auto &inner : sink.spans) {
+        auto outerEnd = outer.begin + outer.duration;
+        auto innerEnd = inner.begin + inner.duration;
+        bool disjoint = innerEnd <= outer.begin || inner.begin >= outerEnd;
+        bool nested = (inner.begin >= outer.begin && innerEnd <= outerEnd) || (outer.begin >= inner.begin && outerEnd <= innerEnd);
+        REQUIRE((disjoint || nested));
+      }
+    }
+    GCodeIRModule other;
+    REQUIRE_THROWS_AS(GCodeTimelineTracer(*module, sink, 0), GCodeRuntimeError);
+    GCodeTimelineTracer foreign(other, sink);
+    REQUIRE_THROWS_AS(interp.setTimeline(&foreign), GCodeRuntimeError);
+    interp.setTimeline(nullptr);
+    REQUIRE(interp.getTimeline() == nullptr);
+  }
+  SECTION("Chrome trace writer") {
+    std::stringstream output;
+    {
+      GCodeChromeTraceWriter writer(output, 7);
+      auto now = GCodeTimelineSpan::Clock::now();
+      writer.record(GCodeTimelineSpan { "compile \"a\"", "compile", now, std::chrono::microseconds(5), 1, {} });
+      writer.record(GCodeTimelineSpan { "syscalls", "syscall", now, std::chrono::microseconds(2), 2, { { "count", 3 } } });
+      REQUIRE(writer.getSpans() == 2);
+    }
+    std::string trace = output.str();
+    REQUIRE(trace.find("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [") == 0);
+    REQUIRE(trace.find("\"name\": \"compile \\\"a\\\"\"") != std::string::npos);
+    REQUIRE(trace.find("\"ph\": \"X\"") != std::string::npos);
+    REQUIRE(trace.find("\"dur\": 5.000, \"pid\": 7, \"tid\": 1}") != std::string::npos);
+    REQUIRE(trace.find("\"tid\": 2, \"args\": {\"count\": 3}}") != std::string::npos);
+    REQUIRE(trace.find("]}") == trace.size() - 3);
+  }
+  SECTION("Thread identifiers") {
+    uint64_t main = GCodeTimelineSink::currentThread();
+    uint64_t other = 0;
+    std::thread thread([&other] {
+      other = GCodeTimelineSink::currentThread();
+    });
+    thread.join();
+    REQUIRE(main != 0);
+    REQUIRE(other != 0);
+    REQUIRE(main != other);
+    REQUIRE(GCodeTimelineSink::currentThread() == main);
+  }
+}
\ No newline at end of file
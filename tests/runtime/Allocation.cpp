@@ -0,0 +1,131 @@
+#include "gcodelib/Frontend.h"
+#include "gcodelib/runtime/Interpreter.h"
+#include "catch.hpp"
+#include <cstdint>
+#include <sstream>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+class GCodeSteadyInterpreter : public GCodeInterpreter {
+ public:
+  using GCodeInterpreter::GCodeInterpreter;
+
+  GCodeVariableScope &getSystemScope() override {
+    return this->scope;
+  }
+
+  double getChecksum() const {
+    return this->checksum;
+  }
+ protected:
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &function, const GCodeSyscallArguments &args) override {
+    this->checksum += function.asFloat() + args.get('X') + args.get('Y');
+  }
+
+  // Only the record path is measured here
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &) override {}
+ private:
+  GCodeCascadeVariableScope scope;
+  double checksum = 0.0;
+};
+
+template <typename Frontend>
+static std::unique_ptr<GCodeIRModule> compile(const std::string &program) {
+  Frontend frontend;
+  std::stringstream is(program);
+  return frontend.compile(is, "steady");
+}
+
+static GCodeAllocationStatistics steady_state(const GCodeIRModule &module, GCodeProfiler *profiler = nullptr) {
+  GCodeSteadyInterpreter interp(module);
+  interp.setProfiler(profiler);
+  interp.start();
+  REQUIRE(interp.runFor(2000) == GCodeExecutionStatus::Yielded);
+  if (profiler != nullptr) {
+    profiler->reset();
+  }
+  GCodeAllocationCounter counter;
+  REQUIRE(interp.runFor(GCodeInterpreter::Unbounded) == GCodeExecutionStatus::Finished);
+  REQUIRE(interp.getChecksum() != 0.0);
+  return GCodeAllocationStatistics { counter.getAllocations(), counter.getAllocatedBytes() };
+}
+
+TEST_CASE("Steady-state allocations") {
+  REQUIRE(GCodeAllocationCounter::isInstrumented());
+  SECTION("Straight-line syscalls") {
+    std::stringstream program;
+    for (int i = 0; i < 2000; i++) {
+      program << "G1 X" << i << " Y" << (i % 7) << ".5 E0.1 F1800" << std::endl;
+    }
+    auto module = compile<GCodeRepRap>(program.str());
+    REQUIRE(steady_state(*module).allocations == 0);
+  }
+  SECTION("Arithmetic loops") {
+    auto module = compile<GCodeLinuxCNC>(
+      "#<acc> = 1\n"
+      "#<idx> = 0\n"
+      "#10 = 0\n"
+      "o100 while [#<idx> LT 1000]\n"
+      "#<acc> = [[#<acc> * 3 + 7] MOD 1000 - 2 / 4]\n"
+      "#10 = [#10 + #<acc> + ABS[SIN[#<idx>]]]\n"
+      "#<idx> = [#<idx> + 1]\n"
+      "o100 endwhile\n"
+      "o101 repeat [500]\n"
+      "G1 X#<acc> Y[#10 MOD 200]\n"
+      "o101 endrepeat\n");
+    REQUIRE(steady_state(*module).allocations == 0);
+  }
+  SECTION("Procedure calls") {
+    auto module = compile<GCodeLinuxCNC>(
+      "o100 sub\n"
+      "#<tmp> = [#0 * 2]\n"
+      "G1 X#<tmp> Y#1\n"
+      "o100 endsub\n"
+      "#<idx> = 0\n"
+      "o101 repeat [1000]\n"
+      "o100 call [#<idx>] [1]\n"
+      "#<idx> = [#<idx> + 1]\n"
+      "o101 endrepeat\n");
+    REQUIRE(steady_state(*module).allocations == 0);
+  }
+  SECTION("Allocation profile") {
+    auto module = compile<GCodeLinuxCNC>(
+      "#<idx> = 0\n"
+      "o100 while [#<idx> LT 1000]\n"
+      "#<idx> = [#<idx> + 1]\n"
+      "G1 X#<idx> Y1\n"
+      "o100 endwhile\n");
+    GCodeProfiler profiler(*module);
+    steady_state(*module, &profiler);
+    std::size_t allocations = 0;
+    for (std::size_t opcode = 0; opcode < GCodeProfiler::OpcodeCount; opcode++) {
+      allocations += profiler.getOpcodeAllocations(static_cast<GCodeIROpcode>(opcode)).allocations;
+    }
+    REQUIRE(allocations == 0);
+  }
+  SECTION("Over-aligned allocations") {
+    struct alignas(128) Block {
+      char data[200];
+    };
+    GCodeAllocationCounter counter;
+    auto block = std::make_unique<Block>();
+    REQUIRE(reinterpret_cast<std::uintptr_t>(block.get()) % 128 == 0);
+    REQUIRE(counter.getAllocations() == 1);
+    REQUIRE(counter.getAllocatedBytes() == sizeof(Block));
+    REQUIRE(counter.getPeakBytes() == sizeof(Block));
+  }
+  SECTION("New handler") {
+    static int calls = 0;
+    calls = 0;
+    std::new_handler previous = std::set_new_handler([]() {
+      calls++;
+      std::set_new_handler(nullptr);
+    });
+    std::size_t huge = SIZE_MAX / 2;
+    REQUIRE_THROWS_AS(::operator new(huge), std::bad_alloc);
+    REQUIRE(calls == 1);
+    REQUIRE(::operator new(huge, std::nothrow) == nullptr);
+    std::set_new_handler(previous);
+  }
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "gcodelib/Frontend.h"
+#include "gcodelib/runtime/Bytecode.h"
+#include "gcodelib/runtime/Interpreter.h"
+#include "gcodelib/runtime/Error.h"
+#include "catch.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sstream>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+class GCodeBytecodeInterpreter : public GCodeInterpreter {
+ public:
+  GCodeBytecodeInterpreter(const GCodeIRModule &module)
+    : GCodeInterpreter(module) {}
+
+  GCodeVariableScope &getSystemScope() override {
+    return this->scope;
+  }
+
+  std::vector<double> commands;
+ protected:
+  void syscall(GCodeSyscallType type, const GCodeRuntimeValue &function, const GCodeScopedDictionary<unsigned char> &args) override {
+    this->commands.push_back(static_cast<double>(type) * 1000 + function.asFloat());
+    for (unsigned char key = 'A'; key <= 'Z'; key++) {
+      if (args.has(key)) {
+        this->commands.push_back(args.get(key).asFloat());
+      }
+    }
+  }
+ private:
+  GCodeCascadeVariableScope scope;
+};
+
+static const char *Program =
+  "#1 = 10\n"
+  "#<depth> = 1.5\n"
+  "o100 sub\n"
+  "  G1 X[#1 * 2] Y[SIN[30]] Z#<depth> F1500\n"
+  "  #1 = [#1 + 1]\n"
+  "o100 endsub\n"
+  "o200 while [#1 LT 15]\n"
+  "  o100 call\n"
+  "o200 endwhile\n"
+  "M30\n";
+
+static std::string dump(const GCodeIRModule &module) {
+  std::stringstream ss;
+  ss << module;
+  return ss.str();
+}
+
+static std::vector<double> run(const GCodeIRModule &module) {
+  GCodeBytecodeInterpreter interp(module);
+  interp.execute();
+  return interp.commands;
+}
+
+TEST_CASE("Bytecode format") {
+  GCodeLinuxCNC compiler;
+  std::stringstream source(Program);
+  auto module = compiler.compile(source, "program.ngc");
+  GCodeBytecodeWriter writer;
+  GCodeBytecodeReader reader;
+  std::stringstream image;
+  writer.write(*module, image);
+  std::string bytes = image.str();
+  SECTION("Round trip") {
+    auto loaded = reader.read(bytes.data(), bytes.size());
+    REQUIRE(loaded->isFrozen());
+    REQUIRE(loaded->length() == module->length());
+    REQUIRE(dump(*loaded) == dump(*module));
+    for (std::size_t addr = 0; addr < module->length(); addr++) {
+      auto expected = module->getSourceMap().locate(addr);
+      auto actual = loaded->getSourceMap().locate(addr);
+      REQUIRE(expected.has_value() == actual.has_value());
+      if (expected.has_value()) {
+        REQUIRE(actual.value().getTag() == expected.value().getTag());
+        REQUIRE(actual.value().getLine() == expected.value().getLine());
+        REQUIRE(actual.value().getColumn() == expected.value().getColumn());
+      }
+    }
+    std::vector<double> commands = run(*module);
+    REQUIRE(commands.size() > 10);
+    REQUIRE(run(*loaded) == commands);
+  }
+  SECTION("Operand types") {
+    GCodeIRModule manual;
+    manual.appendInstruction(GCodeIROpcode::Push, 3.25);
+    manual.appendInstruction(GCodeIROpcode::Push, "text");
+    manual.appendInstruction(GCodeIROpcode::Push, -42L);
+    manual.appendInstruction(GCodeIROpcode::Dup);
+    std::stringstream ss;
+    writer.write(manual, ss);
+    std::string manualBytes = ss.str();
+    auto loaded = reader.read(manualBytes.data(), manualBytes.size());
+    REQUIRE(loaded->length() == 4);
+    REQUIRE(loaded->at(0).getValue().getFloat() == 3.25);
+    REQUIRE(loaded->at(1).getValue().getString() == "text");
+    REQUIRE(loaded->at(2).getValue().getInteger() == -42);
+    REQUIRE(loaded->at(3).getValue().is(GCodeRuntimeValue::Type::None));
+  }
+  SECTION("Files") {
+    char path[] = "/tmp/gcodelib-bytecode-XXXXXX";
+    close(mkstemp(path));
+    writer.write(*module, path);
+    auto loaded = reader.load(path);
+    std::remove(path);
+    REQUIRE(dump(*loaded) == dump(*module));
+    REQUIRE_THROWS_AS(reader.load(path), GCodeRuntimeError);
+  }
+  SECTION("Malformed images") {
+    REQUIRE_THROWS_AS(reader.read(bytes.data(), 10), GCodeRuntimeError);
+    std::string corrupted = bytes;
+    corrupted[0] = 'X';
+    REQUIRE_THROWS_AS(reader.read(corrupted.data(), corrupted.size()), GCodeRuntimeError);
+    corrupted = bytes;
+    corrupted[corrupted.size() - 1] ^= 0x55;
+    REQUIRE_THROWS_AS(reader.read(corrupted.data(), corrupted.size()), GCodeRuntimeError);
+    REQUIRE_THROWS_AS(reader.read(bytes.data(), bytes.size() - 3), GCodeRuntimeError);
+    // A huge string count with a valid checksum must be rejected before anything is allocated
+    corrupted = bytes;
+    const std::size_t payload = 24 + 6 * 24;
+    const uint32_t count = UINT32_MAX;
+    std::memcpy(&corrupted[payload], &count, sizeof(count));
+    uint64_t checksum = 14695981039346656037ULL;
+    for (std::size_t i = payload; i < corrupted.size(); i++) {
+      checksum ^= static_cast<unsigned char>(corrupted[i]);
+      checksum *= 1099511628211ULL;
+    }
+    std::memcpy(&corrupted[16], &checksum, sizeof(checksum));
+    REQUIRE_THROWS_AS(reader.read(corrupted.data(), corrupted.size()), GCodeRuntimeError);
+  }
+}
\ No newline at end of file
@@ -18,4 +18,10 @@ TEST_CASE("Configuration") {
   REQUIRE_FALSE(config.hasComparisonTolerance());
   REQUIRE(GCodeRuntimeConfig::Default.getComparisonTolerance() == GCodeRuntimeConfig::DefaultComparisonTolerance);
   REQUIRE(GCodeRuntimeConfig::Default.hasComparisonTolerance());
+  REQUIRE(config.getCallStackDepth() == GCodeRuntimeConfig::DefaultCallStackDepth);
+  REQUIRE_FALSE(config.setCallStackDepth(0));
+  REQUIRE(config.getCallStackDepth() == GCodeRuntimeConfig::DefaultCallStackDepth);
+  REQUIRE(config.setCallStackDepth(8));
+  REQUIRE(config.getCallStackDepth() == 8);
+  REQUIRE(GCodeRuntimeConfig::Default.getCallStackDepth() == GCodeRuntimeConfig::DefaultCallStackDepth);
 }
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "gcodelib/Frontend.h"
+#include "gcodelib/runtime/Interpreter.h"
+#include "catch.hpp"
+#include <algorithm>
+#include <sstream>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+class GCodeCoverageInterpreter : public GCodeInterpreter {
+ public:
+  using GCodeInterpreter::GCodeInterpreter;
+
+  GCodeVariableScope &getSystemScope() override {
+    return this->scope;
+  }
+ protected:
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &) override {}
+ private:
+  GCodeCascadeVariableScope scope;
+};
+
+static std::unique_ptr<GCodeIRModule> compile_program(const std::string &source) {
+  GCodeLinuxCNC linuxcnc;
+  std::stringstream program(source);
+  return linuxcnc.compile(program, "coverage");
+}
+
+static std::unique_ptr<GCodeIRModule> compile_program() {
+  return compile_program(
+    "o100 sub\n"
+    "G1 X#0\n"
+    "o100 endsub\n"
+    "#<idx> = 0\n"
+    "o101 if [#<idx> GT 5]\n"
+    "G0 X100\n"
+    "o101 endif\n"
+    "o100 call [1]\n"
+    "G1 Y2\n");
+}
+
+static void require_line(const std::vector<GCodeCoverageLine> &lines, uint32_t line, std::size_t instructions, std::size_t covered) {
+  auto it = std::find_if(lines.begin(), lines.end(), [&](const GCodeCoverageLine &entry) {
+    return entry.line == line;
+  });
+  INFO("Line " << line);
+  REQUIRE(it != lines.end());
+  REQUIRE(it->instructions == instructions);
+  REQUIRE(it->covered == covered);
+}
+
+TEST_CASE("Coverage bitmap") {
+  GCodeCoverageBitmap first(130);
+  GCodeCoverageBitmap second(130);
+  REQUIRE(first.size() == 130);
+  REQUIRE(first.count() == 0);
+  first.set(0);
+  first.set(64);
+  second.set(64);
+  second.set(129);
+  REQUIRE(first.test(0));
+  REQUIRE_FALSE(first.test(1));
+  REQUIRE_FALSE(first.test(130));
+  REQUIRE(first != second);
+  first |= second;
+  REQUIRE(first.count() == 3);
+  REQUIRE(first.test(129));
+  std::stringstream stream;
+  first.write(stream);
+  GCodeCoverageBitmap restored = GCodeCoverageBitmap::read(stream);
+  REQUIRE(restored == first);
+  GCodeCoverageBitmap other(10);
+  REQUIRE_THROWS_AS(first |= other, GCodeRuntimeError);
+  std::stringstream malformed("GCIR");
+  REQUIRE_THROWS_AS(GCodeCoverageBitmap::read(malformed), GCodeRuntimeError);
+  std::string image = stream.str();
+  std::stringstream matching(image);
+  REQUIRE(GCodeCoverageBitmap::read(matching, 130) == first);
+  std::stringstream mismatched(image);
+  REQUIRE_THROWS_AS(GCodeCoverageBitmap::read(mismatched, 131), GCodeRuntimeError);
+  std::string huge = image.substr(0, 8) + std::string("\0\0\0\0\0\0\0\x40", 8) + image.substr(16);
+  std::stringstream oversized(huge);
+  GCodeAllocationCounter counter;
+  REQUIRE_THROWS_AS(GCodeCoverageBitmap::read(oversized), GCodeRuntimeError);
+  REQUIRE(counter.getPeakBytes() < (1 << 20));
+  first.clear();
+  REQUIRE(first.count() == 0);
+}
+
+TEST_CASE("Coverage") {
+  auto module = compile_program();
+  GCodeCoverageInterpreter interp(*module);
+  GCodeCoverage coverage(*module);
+  REQUIRE(coverage.getBitmap().size() == module->length());
+  SECTION("Executed lines") {
+    interp.setCoverage(&coverage);
+    REQUIRE(interp.getCoverage() == &coverage);
+    interp.execute();
+    auto lines = coverage.getLines();
+    REQUIRE(lines.size() == 7);
+    require_line(lines, 1, 1, 1);
+    require_line(lines, 2, 5, 5);
+    require_line(lines, 4, 2, 2);
+    require_line(lines, 5, 6, 6);
+    require_line(lines, 6, 5, 0);
+    require_line(lines, 8, 3, 3);
+    require_line(lines, 9, 5, 5);
+    for (const auto &line : lines) {
+      REQUIRE(line.tag == "coverage");
+    }
+    std::stringstream lcov;
+    coverage.writeLcov(lcov);
+    REQUIRE(lcov.str().find("SF:coverage\n") == 0);
+    REQUIRE(lcov.str().find("DA:6,0\n") != std::string::npos);
+    REQUIRE(lcov.str().find("DA:9,1\n") != std::string::npos);
+    REQUIRE(lcov.str().find("end_of_record\n") == lcov.str().size() - 14);
+  }
+  SECTION("Uncalled procedures") {
+    auto uncalled = compile_program(
+      "o100 sub\n"
+      "G1 X1\n"
+      "G1 X2\n"
+      "o100 endsub\n"
+      "#1 = 0\n"
+      "o200 if [#1 GT 1]\n"
+      "G1 X3\n"
+      "o200 endif\n"
+      "G1 X4\n");
+    GCodeCoverageInterpreter uncalledInterp(*uncalled);
+    GCodeCoverage uncalledCoverage(*uncalled);
+    uncalledInterp.setCoverage(&uncalledCoverage);
+    uncalledInterp.execute();
+    auto lines = uncalledCoverage.getLines();
+    REQUIRE(lines.size() == 7);
+    require_line(lines, 1, 1, 0);
+    require_line(lines, 2, 5, 0);
+    require_line(lines, 3, 5, 0);
+    require_line(lines, 5, 2, 2);
+    require_line(lines, 6, 6, 6);
+    require_line(lines, 7, 5, 0);
+    require_line(lines, 9, 5, 5);
+    std::stringstream lcov;
+    uncalledCoverage.writeLcov(lcov);
+    REQUIRE(lcov.str().find("DA:1,0\n") != std::string::npos);
+    REQUIRE(lcov.str().find("DA:2,0\n") != std::string::npos);
+    REQUIRE(lcov.str().find("LF:7\nLH:3\n") != std::string::npos);
+  }
+  SECTION("Merging runs") {
+    interp.setCoverage(&coverage);
+    interp.start();
+    REQUIRE(interp.runFor(3) == GCodeExecutionStatus::Yielded);
+    GCodeCoverageBitmap partial = coverage.getBitmap();
+    REQUIRE(partial.count() == 3);
+    GCodeCoverageInterpreter full(*module);
+    GCodeCoverage fullCoverage(*module);
+    full.setCoverage(&fullCoverage);
+    full.execute();
+    coverage.merge(fullCoverage.getBitmap());
+    REQUIRE(coverage.getBitmap() == fullCoverage.getBitmap());
+    coverage.reset();
+    REQUIRE(coverage.getBitmap().count() == 0);
+    coverage.merge(partial);
+    REQUIRE(GCodeCoverage::getLines(*module, partial).size() == coverage.getLines().size());
+  }
+  SECTION("Module binding") {
+    GCodeIRModule other;
+    GCodeCoverage foreign(other);
+    REQUIRE_THROWS_AS(interp.setCoverage(&foreign), GCodeRuntimeError);
+    REQUIRE_THROWS_AS(GCodeCoverage::getLines(*module, foreign.getBitmap()), GCodeRuntimeError);
+    interp.setCoverage(nullptr);
+    REQUIRE(interp.getCoverage() == nullptr);
+  }
+}
\ No newline at end of file
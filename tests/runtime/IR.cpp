@@ -1,8 +1,10 @@
 #include "catch.hpp"
 #include "gcodelib/runtime/IR.h"
+#include "gcodelib/runtime/Error.h"
 #include <sstream>
 #include <iostream>
 #include <regex>
+#include <type_traits>
 
 using namespace GCodeLib::Runtime;
 
@@ -163,4 +165,44 @@ TEST_CASE("IR module output") {
   std::getline(ss, line);
   REQUIRE(line.empty());
   REQUIRE(ss.eof());
+}
+
+TEST_CASE("IR module freezing") {
+  GCodeIRModule module;
+  module.getSymbolId("test");
+  auto label = module.newLabel();
+  auto &named = module.getNamedLabel("proc");
+  module.appendInstruction(GCodeIROpcode::Push, 1L);
+  SECTION("Unbound labels") {
+    REQUIRE_THROWS(module.freeze());
+    REQUIRE_FALSE(module.isFrozen());
+  }
+  named.bind();
+  module.registerProcedure(0, "proc");
+  module.appendInstruction(GCodeIROpcode::Ret);
+  REQUIRE_FALSE(module.isFrozen());
+  REQUIRE_NOTHROW(module.freeze());
+  REQUIRE(module.isFrozen());
+  SECTION("Mutation") {
+    REQUIRE_THROWS_AS(module.appendInstruction(GCodeIROpcode::Push, 2L), GCodeRuntimeError);
+    REQUIRE_THROWS_AS(module.getSymbolId("other"), GCodeRuntimeError);
+    REQUIRE_THROWS_AS(module.newLabel(), GCodeRuntimeError);
+    REQUIRE_THROWS_AS(module.getNamedLabel("other"), GCodeRuntimeError);
+    REQUIRE_THROWS_AS(module.registerProcedure(1, "proc"), GCodeRuntimeError);
+    REQUIRE_THROWS_AS(label->bind(), GCodeRuntimeError);
+    REQUIRE_THROWS_AS(module.newPositionRegister(GCodeLib::Parser::SourcePosition("", 1, 1, 0)), GCodeRuntimeError);
+    REQUIRE(module.length() == 2);
+  }
+  SECTION("Read access") {
+    const GCodeIRModule &ref = module;
+    REQUIRE(module.getSymbolId("test") == 0);
+    REQUIRE(&module.getNamedLabel("proc") == &named);
+    REQUIRE(ref.getSymbol(0).compare("test") == 0);
+    REQUIRE(ref.getProcedure(0).getAddress() == 1);
+    // A frozen module hands out no mutable source map or procedure labels
+    static_assert(std::is_same_v<decltype(module.getSourceMap()), const IRSourceMap &>);
+    static_assert(std::is_same_v<decltype(ref.getProcedure(0)), const GCodeIRLabel &>);
+    REQUIRE(ref.at(0).getValue().getInteger() == 1);
+    REQUIRE_FALSE(ref.getSourceMap().locate(0).has_value());
+  }
 }
\ No newline at end of file
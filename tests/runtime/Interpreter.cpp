@@ -3,6 +3,7 @@
 #include "gcodelib/runtime/Error.h"
 #include <functional>
 #include <cmath>
+#include <thread>
 
 using namespace GCodeLib::Runtime;
 
@@ -75,6 +76,26 @@ static void expectSyscall(GCodeIRModule &module, GCodeTestInterpreter::SyscallHo
   REQUIRE((count < 0 || realCount == count));
 }
 
+class GCodeRecordInterpreter : public GCodeInterpreter {
+ public:
+  using SyscallHookFn = std::function<void(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeSyscallArguments &)>;
+  GCodeRecordInterpreter(const GCodeIRModule &module, SyscallHookFn syscall)
+    : GCodeInterpreter(module), syscallHook(syscall) {}
+
+  GCodeVariableScope &getSystemScope() override {
+    return scope;
+  }
+ protected:
+  void syscall(GCodeSyscallType syscall, const GCodeRuntimeValue &function, const GCodeSyscallArguments &args) override {
+    this->syscallHook(syscall, function, args);
+  }
+
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &) override {}
+ private:
+  GCodeCascadeVariableScope scope;
+  SyscallHookFn syscallHook;
+};
+
 static constexpr int64_t IntConstants[] = {
   100,
   200,
@@ -349,6 +370,38 @@ TEST_CASE("Invocation instructions") {
       REQUIRE(args.get('X').getInteger() == IntConstants[0]);
     });
   }
+  SECTION("Syscall argument records") {
+    auto ir = make_ir({
+      { GCodeIROpcode::Prologue },
+      { GCodeIROpcode::Push, IntConstants[0] },
+      { GCodeIROpcode::SetArg, static_cast<int64_t>('X') },
+      { GCodeIROpcode::Push, FloatConstants[0] },
+      { GCodeIROpcode::SetArg, static_cast<int64_t>('F') },
+      { GCodeIROpcode::Push, 1L },
+      { GCodeIROpcode::Syscall, static_cast<int64_t>(GCodeSyscallType::General) }
+    });
+    int32_t count = 0;
+    GCodeRecordInterpreter interp(*ir, [&](GCodeSyscallType type, const GCodeRuntimeValue &function, const GCodeSyscallArguments &args) {
+      REQUIRE(type == GCodeSyscallType::General);
+      REQUIRE(function.getInteger() == 1L);
+      REQUIRE(args.getMask() == (GCodeSyscallArguments::bit('X') | GCodeSyscallArguments::bit('F')));
+      REQUIRE(args.get('X') == Approx(IntConstants[0]));
+      REQUIRE(args.get('F') == Approx(FloatConstants[0]));
+      REQUIRE(args.getValue('X').getInteger() == IntConstants[0]);
+      count++;
+    });
+    interp.execute();
+    REQUIRE(count == 1);
+  }
+  SECTION("Invalid syscall arguments") {
+    auto ir = make_ir({
+      { GCodeIROpcode::Prologue },
+      { GCodeIROpcode::Push, IntConstants[0] },
+      { GCodeIROpcode::SetArg, static_cast<int64_t>('#') }
+    });
+    GCodeTestInterpreter interp(*ir, [](GCodeRuntimeState &) {});
+    REQUIRE_THROWS_AS(interp.execute(), GCodeRuntimeError);
+  }
   SECTION("Zero-argument calls") {
     GCodeIRModule module;
     auto &label = module.getNamedLabel("label");
@@ -570,4 +623,210 @@ TEST_CASE("Error handling") {
       REQUIRE_FALSE(err.getLocation().has_value());
     }
   }
+}
+
+TEST_CASE("Batched execution") {
+  GCodeIRModule module;
+  for (int64_t i = 0; i < 5; i++) {
+    module.appendInstruction(GCodeIROpcode::Prologue);
+    module.appendInstruction(GCodeIROpcode::Push, i);
+    module.appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('X'));
+    module.appendInstruction(GCodeIROpcode::Push, 1L);
+    module.appendInstruction(GCodeIROpcode::Syscall, static_cast<int64_t>(GCodeSyscallType::General));
+  }
+  GCodeCommandRecord buffer[4];
+  std::size_t syscalls = 0;
+  GCodeTestInterpreter interp(module, [](GCodeRuntimeState &) {}, [&](GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &) {
+    syscalls++;
+  });
+  SECTION("Buffer capacity") {
+    REQUIRE_THROWS(interp.executeBatch(buffer, 2));
+    interp.start();
+    REQUIRE_FALSE(interp.isFinished());
+    REQUIRE_THROWS(interp.executeBatch(buffer, 0));
+    std::vector<double> values;
+    std::vector<std::size_t> sizes;
+    while (!interp.isFinished()) {
+      GCodeCommandSpan span = interp.executeBatch(buffer, 2);
+      sizes.push_back(span.size());
+      for (const auto &cmd : span) {
+        REQUIRE(cmd.type == GCodeSyscallType::General);
+        REQUIRE(cmd.function == 1.0);
+        REQUIRE(cmd.has('X'));
+        REQUIRE_FALSE(cmd.has('Y'));
+        values.push_back(cmd.get('X'));
+      }
+    }
+    REQUIRE(sizes == std::vector<std::size_t>{2, 2, 1});
+    REQUIRE(values == std::vector<double>{0, 1, 2, 3, 4});
+    REQUIRE(syscalls == 0);
+    REQUIRE(interp.executeBatch(buffer, 2).empty());
+  }
+  SECTION("System variable reads") {
+    interp.getSystemScope().getNumbered().put(5061, 100L);
+    module.appendInstruction(GCodeIROpcode::LoadNumbered, 5061L);
+    module.appendInstruction(GCodeIROpcode::StoreNumbered, 1L);
+    module.appendInstruction(GCodeIROpcode::Prologue);
+    module.appendInstruction(GCodeIROpcode::Push, 1L);
+    module.appendInstruction(GCodeIROpcode::Syscall, static_cast<int64_t>(GCodeSyscallType::Misc));
+    interp.start();
+    GCodeCommandSpan span = interp.executeBatch(buffer, 4);
+    REQUIRE(span.size() == 4);
+    span = interp.executeBatch(buffer, 4);
+    REQUIRE(span.size() == 1);
+    REQUIRE_FALSE(interp.isFinished());
+    span = interp.executeBatch(buffer, 4);
+    REQUIRE(span.size() == 1);
+    REQUIRE(span[0].type == GCodeSyscallType::Misc);
+    REQUIRE(span[0].mask == 0);
+    REQUIRE(interp.isFinished());
+  }
+}
+
+TEST_CASE("Resumable execution") {
+  GCodeIRModule module;
+  for (int64_t i = 0; i < 3; i++) {
+    module.appendInstruction(GCodeIROpcode::Prologue);
+    module.appendInstruction(GCodeIROpcode::Push, i);
+    module.appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('X'));
+    module.appendInstruction(GCodeIROpcode::Push, 1L);
+    module.appendInstruction(GCodeIROpcode::Syscall, static_cast<int64_t>(GCodeSyscallType::General));
+  }
+  std::vector<int64_t> syscalls;
+  GCodeTestInterpreter interp(module, [](GCodeRuntimeState &) {}, [&](GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &args) {
+    syscalls.push_back(args.get('X').getInteger());
+  });
+  SECTION("Instruction budget") {
+    REQUIRE_THROWS(interp.runFor(1));
+    interp.start();
+    REQUIRE(interp.runFor(0) == GCodeExecutionStatus::Yielded);
+    REQUIRE(interp.runFor(4) == GCodeExecutionStatus::Yielded);
+    REQUIRE(syscalls.empty());
+    REQUIRE(interp.runFor(1) == GCodeExecutionStatus::Yielded);
+    REQUIRE(syscalls == std::vector<int64_t>{0});
+    REQUIRE(interp.runFor(4) == GCodeExecutionStatus::Yielded);
+    REQUIRE(syscalls == std::vector<int64_t>{0});
+    REQUIRE(interp.runFor(100) == GCodeExecutionStatus::Finished);
+    REQUIRE(syscalls == std::vector<int64_t>{0, 1, 2});
+    REQUIRE(interp.runFor(100) == GCodeExecutionStatus::Finished);
+    REQUIRE_FALSE(interp.getError().has_value());
+  }
+  SECTION("Syscall boundaries") {
+    interp.start();
+    REQUIRE(interp.runUntilSyscall() == GCodeExecutionStatus::Yielded);
+    REQUIRE(syscalls == std::vector<int64_t>{0});
+    REQUIRE(interp.runUntilSyscall(2) == GCodeExecutionStatus::Yielded);
+    REQUIRE(syscalls == std::vector<int64_t>{0});
+    REQUIRE(interp.runUntilSyscall() == GCodeExecutionStatus::Yielded);
+    REQUIRE(syscalls == std::vector<int64_t>{0, 1});
+    REQUIRE(interp.runUntilSyscall() == GCodeExecutionStatus::Finished);
+    REQUIRE(syscalls == std::vector<int64_t>{0, 1, 2});
+  }
+  SECTION("Errors") {
+    module.appendInstruction(GCodeIROpcode::Add);
+    interp.start();
+    REQUIRE(interp.runFor(GCodeInterpreter::Unbounded) == GCodeExecutionStatus::Error);
+    REQUIRE(interp.getError().has_value());
+    REQUIRE(interp.runFor(1) == GCodeExecutionStatus::Error);
+    REQUIRE(syscalls.size() == 3);
+    interp.start();
+    REQUIRE_FALSE(interp.getError().has_value());
+  }
+}
+
+TEST_CASE("Shared modules") {
+  constexpr std::size_t Threads = 4;
+  constexpr int64_t Commands = 200;
+  GCodeIRModule module;
+  for (int64_t i = 0; i < Commands; i++) {
+    module.appendInstruction(GCodeIROpcode::Prologue);
+    module.appendInstruction(GCodeIROpcode::Push, i);
+    module.appendInstruction(GCodeIROpcode::Push, 2L);
+    module.appendInstruction(GCodeIROpcode::Multiply);
+    module.appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('X'));
+    module.appendInstruction(GCodeIROpcode::Push, 1L);
+    module.appendInstruction(GCodeIROpcode::Syscall, static_cast<int64_t>(GCodeSyscallType::General));
+  }
+  module.freeze();
+  const GCodeIRModule &shared = module;
+  std::vector<std::vector<double>> results(Threads);
+  std::vector<std::thread> workers;
+  for (std::size_t i = 0; i < Threads; i++) {
+    workers.emplace_back([&shared, &result = results[i]]() {
+      GCodeRecordInterpreter interp(shared, [&](GCodeSyscallType, const GCodeRuntimeValue &, const GCodeSyscallArguments &args) {
+        result.push_back(args.get('X'));
+      });
+      interp.execute();
+      interp.execute();
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  std::vector<double> expected;
+  for (int j = 0; j < 2; j++) {
+    for (int64_t i = 0; i < Commands; i++) {
+      expected.push_back(i * 2.0);
+    }
+  }
+  for (const auto &result : results) {
+    REQUIRE(result == expected);
+  }
+}
+
+TEST_CASE("Fast-forward") {
+  GCodeIRModule module;
+  std::vector<GCodeLib::Parser::SourcePosition> positions;
+  for (uint32_t line = 1; line <= 5; line++) {
+    positions.push_back(GCodeLib::Parser::SourcePosition("test", line, 1, 0));
+  }
+  for (uint32_t line = 1; line <= 5; line++) {
+    auto position = module.newPositionRegister(positions[line - 1]);
+    module.appendInstruction(GCodeIROpcode::Prologue);
+    module.appendInstruction(GCodeIROpcode::Push, static_cast<int64_t>(line));
+    module.appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('X'));
+    module.appendInstruction(GCodeIROpcode::Push, static_cast<int64_t>(line * 10));
+    module.appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('Y'));
+    if (line == 2) {
+      module.appendInstruction(GCodeIROpcode::Push, 500L);
+      module.appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('F'));
+    }
+    module.appendInstruction(GCodeIROpcode::Push, line == 3 ? 3L : 1L);
+    module.appendInstruction(GCodeIROpcode::Syscall, static_cast<int64_t>(line == 3 ? GCodeSyscallType::Misc : GCodeSyscallType::General));
+  }
+  std::vector<int64_t> syscalls;
+  GCodeTestInterpreter interp(module, [](GCodeRuntimeState &) {}, [&](GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &args) {
+    syscalls.push_back(args.get('X').getInteger());
+  });
+  SECTION("Seeking a line") {
+    REQUIRE_THROWS(interp.fastForward(4));
+    interp.start();
+    REQUIRE_THROWS(interp.fastForward(10));
+    REQUIRE_THROWS(interp.fastForward("other", 4));
+    GCodeFastForwardSummary summary = interp.fastForward("test", 4, "XF");
+    REQUIRE(summary.reached);
+    REQUIRE(summary.address == 23);
+    REQUIRE(summary.instructions == 23);
+    REQUIRE(summary.syscalls == 3);
+    REQUIRE(summary.modal.get('X') == 3);
+    REQUIRE(summary.modal.get('F') == 500);
+    REQUIRE_FALSE(summary.modal.has('Y'));
+    REQUIRE(summary.functions.at(GCodeSyscallType::General) == 1);
+    REQUIRE(summary.functions.at(GCodeSyscallType::Misc) == 3);
+    REQUIRE(syscalls.empty());
+    REQUIRE(interp.runUntilSyscall() == GCodeExecutionStatus::Yielded);
+    REQUIRE(syscalls == std::vector<int64_t>{4});
+    REQUIRE(interp.runFor(GCodeInterpreter::Unbounded) == GCodeExecutionStatus::Finished);
+    REQUIRE(syscalls == std::vector<int64_t>{4, 5});
+  }
+  SECTION("Passed lines") {
+    interp.start();
+    REQUIRE(interp.fastForward(1).reached);
+    REQUIRE(interp.fastForward(3).reached);
+    GCodeFastForwardSummary summary = interp.fastForward(2);
+    REQUIRE_FALSE(summary.reached);
+    REQUIRE(summary.syscalls == 3);
+    REQUIRE(interp.isFinished());
+    REQUIRE(syscalls.empty());
+  }
 }
\ No newline at end of file
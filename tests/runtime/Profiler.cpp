@@ -0,0 +1,104 @@
+#include "gcodelib/Frontend.h"
+#include "gcodelib/runtime/Interpreter.h"
+#include "catch.hpp"
+#include <sstream>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+static const std::string Program = "o200 sub\n"
+  "G1 X#0\n"
+  "o200 endsub\n"
+  "o100 sub\n"
+  "o200 call [#0]\n"
+  "o200 call [[#0 + 1]]\n"
+  "o100 endsub\n"
+  "o100 call [1]\n"
+  "o100 call [2]\n"
+  "o200 call [5]\n";
+
+class GCodeProfiledInterpreter : public GCodeInterpreter {
+ public:
+  using GCodeInterpreter::GCodeInterpreter;
+
+  GCodeVariableScope &getSystemScope() override {
+    return this->scope;
+  }
+ protected:
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &) override {}
+ private:
+  GCodeCascadeVariableScope scope;
+};
+
+TEST_CASE("Profiler") {
+  GCodeLinuxCNC linuxcnc;
+  std::stringstream ss(Program);
+  auto module = linuxcnc.compile(ss, "profile");
+  GCodeProfiledInterpreter interp(*module);
+  GCodeProfiler profiler(*module, 1);
+  REQUIRE_THROWS(GCodeProfiler(*module, 0));
+  interp.setProfiler(&profiler);
+  REQUIRE(interp.getProfiler() == &profiler);
+  interp.start();
+  REQUIRE(interp.runFor(GCodeInterpreter::Unbounded) == GCodeExecutionStatus::Finished);
+
+  uint64_t total = profiler.getInstructions();
+  REQUIRE(total > 0);
+  REQUIRE(profiler.getTime().count() > 0);
+  REQUIRE(profiler.getOpcodeCount(GCodeIROpcode::Syscall) == 5);
+  REQUIRE(profiler.getOpcodeCount(GCodeIROpcode::Call) == 7);
+  REQUIRE(profiler.getOpcodeCount(GCodeIROpcode::Ret) == 7);
+
+  std::vector<GCodeProfileProcedure> procedures = profiler.getProcedures();
+  REQUIRE(procedures.size() == 2);
+  const GCodeProfileProcedure &o100 = procedures[0].id == 100 ? procedures[0] : procedures[1];
+  const GCodeProfileProcedure &o200 = procedures[0].id == 200 ? procedures[0] : procedures[1];
+  REQUIRE(o100.calls == 2);
+  REQUIRE(o200.calls == 5);
+  REQUIRE(o200.inclusive.instructions == o200.exclusive.instructions);
+  REQUIRE(o100.inclusive.instructions > o100.exclusive.instructions);
+  REQUIRE(o100.inclusive.instructions < total);
+  REQUIRE(o100.exclusive.instructions + o200.exclusive.instructions < total);
+
+  std::vector<GCodeProfileLine> lines = profiler.getLines();
+  uint64_t attributed = 0;
+  for (const auto &line : lines) {
+    REQUIRE(line.tag == "profile");
+    attributed += line.counter.instructions;
+  }
+  REQUIRE(attributed <= total);
+  auto body = std::find_if(lines.begin(), lines.end(), [](const GCodeProfileLine &line) {
+    return line.line == 2;
+  });
+  REQUIRE(body != lines.end());
+  REQUIRE(body->counter.instructions > 0);
+
+  std::stringstream folded;
+  profiler.writeFolded(folded);
+  std::map<std::string, uint64_t> stacks;
+  std::string stack;
+  uint64_t weight, sum = 0;
+  while (folded >> stack >> weight) {
+    stacks[stack] = weight;
+    sum += weight;
+  }
+  REQUIRE(sum == total);
+  REQUIRE(stacks.count("main") == 1);
+  REQUIRE(stacks.count("main;o100") == 1);
+  REQUIRE(stacks.count("main;o100;o200") == 1);
+  REQUIRE(stacks.count("main;o200") == 1);
+  REQUIRE(stacks["main;o100;o200"] + stacks["main;o200"] == o200.exclusive.instructions);
+
+  profiler.reset();
+  REQUIRE(profiler.getInstructions() == 0);
+  REQUIRE(profiler.getProcedures().empty());
+  interp.setProfiler(nullptr);
+  interp.start();
+  interp.runFor(GCodeInterpreter::Unbounded);
+  REQUIRE(profiler.getInstructions() == 0);
+
+  std::stringstream otherSource("G0 X1\n");
+  auto other = linuxcnc.compile(otherSource, "other");
+  GCodeProfiler foreign(*other);
+  REQUIRE_THROWS(interp.setProfiler(&foreign));
+}
\ No newline at end of file
@@ -349,6 +349,37 @@ TEST_CASE("Call-Return") {
   REQUIRE_THROWS(state.ret());
 }
 
+TEST_CASE("Call frames") {
+  GCodeRuntimeConfig config;
+  config.setCallStackDepth(4);
+  GCodeCascadeVariableScope scope;
+  GCodeRuntimeState state(scope, config);
+  SECTION("Frame reuse") {
+    REQUIRE(state.getCallDepth() == 0);
+    REQUIRE_NOTHROW(state.call(100));
+    REQUIRE(state.getCallDepth() == 1);
+    GCodeVariableScope &frame = state.getScope();
+    frame.getNumbered().put(1, 100L);
+    REQUIRE_NOTHROW(state.call(200));
+    REQUIRE(&state.getScope() != &frame);
+    REQUIRE_FALSE(state.getScope().getNumbered().has(1));
+    REQUIRE_NOTHROW(state.ret());
+    REQUIRE(state.getScope().getNumbered().get(1).getInteger() == 100L);
+    REQUIRE_NOTHROW(state.ret());
+    REQUIRE_FALSE(state.getScope().getNumbered().has(1));
+    REQUIRE_NOTHROW(state.call(100));
+    REQUIRE(&state.getScope() == &frame);
+    REQUIRE_FALSE(state.getScope().getNumbered().has(1));
+  }
+  SECTION("Stack depth") {
+    for (std::size_t i = 0; i < config.getCallStackDepth(); i++) {
+      REQUIRE_NOTHROW(state.call(i));
+    }
+    REQUIRE_THROWS(state.call(100));
+    REQUIRE(state.getCallDepth() == config.getCallStackDepth());
+  }
+}
+
 TEST_CASE("Function scope") {
   GCodeFunctionScope scope;
   REQUIRE_FALSE(scope.hasFunction("fn1"));
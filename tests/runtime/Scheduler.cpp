@@ -0,0 +1,209 @@
+#include "catch.hpp"
+#include "gcodelib/runtime/Scheduler.h"
+#include <chrono>
+
+using namespace GCodeLib::Runtime;
+
+class GCodeJobInterpreter : public GCodeInterpreter {
+ public:
+  using GCodeInterpreter::GCodeInterpreter;
+
+  GCodeVariableScope &getSystemScope() override {
+    return this->scope;
+  }
+ protected:
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &) override {}
+ private:
+  GCodeCascadeVariableScope scope;
+};
+
+static std::unique_ptr<GCodeIRModule> make_program(int64_t commands) {
+  std::unique_ptr<GCodeIRModule> module = std::make_unique<GCodeIRModule>();
+  for (int64_t i = 0; i < commands; i++) {
+    module->appendInstruction(GCodeIROpcode::Prologue);
+    module->appendInstruction(GCodeIROpcode::Push, i);
+    module->appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('X'));
+    module->appendInstruction(GCodeIROpcode::Push, 1L);
+    module->appendInstruction(GCodeIROpcode::Syscall, static_cast<int64_t>(GCodeSyscallType::General));
+  }
+  module->freeze();
+  return module;
+}
+
+template <typename F>
+static bool wait_for(F condition) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+TEST_CASE("Job scheduler") {
+  SECTION("Multiplexed jobs") {
+    constexpr std::size_t Jobs = 32;
+    constexpr int64_t Commands = 100;
+    auto module = make_program(Commands);
+    std::vector<std::unique_ptr<GCodeJobInterpreter>> interpreters;
+    std::vector<std::vector<double>> results(Jobs);
+    GCodeJobScheduler scheduler(2, 64);
+    REQUIRE(scheduler.getWorkerCount() == 2);
+    REQUIRE(scheduler.getQuantum() == 64);
+    std::vector<GCodeScheduledJob *> jobs;
+    for (std::size_t i = 0; i < Jobs; i++) {
+      interpreters.push_back(std::make_unique<GCodeJobInterpreter>(*module));
+      jobs.push_back(&scheduler.submit(*interpreters.back(), 1, 8, 4));
+    }
+    REQUIRE(wait_for([&]() {
+      bool done = true;
+      for (std::size_t i = 0; i < Jobs; i++) {
+        GCodeCommandRecord record;
+        while (jobs[i]->tryPop(record)) {
+          results[i].push_back(record.get('X'));
+        }
+        done = done && jobs[i]->isDone();
+      }
+      return done;
+    }));
+    std::vector<double> expected;
+    for (int64_t i = 0; i < Commands; i++) {
+      expected.push_back(static_cast<double>(i));
+    }
+    for (std::size_t i = 0; i < Jobs; i++) {
+      REQUIRE(jobs[i]->getState() == GCodeScheduledJob::State::Finished);
+      REQUIRE(results[i] == expected);
+      GCodeJobStatistics stats = jobs[i]->getStatistics();
+      REQUIRE(stats.commands == Commands);
+      REQUIRE(stats.slices >= Commands / 4);
+      REQUIRE(stats.maxLatency >= stats.getMeanLatency());
+    }
+    GCodeSchedulerStatistics stats = scheduler.getStatistics();
+    REQUIRE(stats.jobs == Jobs);
+    REQUIRE(stats.total.commands == Jobs * Commands);
+  }
+  SECTION("Priorities") {
+    auto module = make_program(30);
+    GCodeJobInterpreter low(*module), high(*module);
+    GCodeJobScheduler scheduler(1, 5);
+    REQUIRE_THROWS(scheduler.submit(low, 0));
+    GCodeScheduledJob &lowJob = scheduler.submit(low, 1, 64, 16);
+    GCodeScheduledJob &highJob = scheduler.submit(high, 3, 64, 16);
+    REQUIRE(lowJob.getPriority() == 1);
+    REQUIRE(highJob.getPriority() == 3);
+    REQUIRE(wait_for([&]() {
+      return lowJob.getState() == GCodeScheduledJob::State::Finished &&
+        highJob.getState() == GCodeScheduledJob::State::Finished;
+    }));
+    GCodeJobStatistics lowStats = lowJob.getStatistics();
+    GCodeJobStatistics highStats = highJob.getStatistics();
+    REQUIRE(lowStats.commands == 30);
+    REQUIRE(highStats.commands == 30);
+    REQUIRE(lowStats.slices >= 30);
+    REQUIRE(highStats.slices >= 10);
+    REQUIRE(highStats.slices < lowStats.slices);
+  }
+  SECTION("Backpressure") {
+    auto module = make_program(50);
+    GCodeJobInterpreter interp(*module);
+    GCodeJobScheduler scheduler(1);
+    GCodeScheduledJob &job = scheduler.submit(interp, 1, 4, 4);
+    REQUIRE(wait_for([&]() {
+      return job.getState() == GCodeScheduledJob::State::Blocked;
+    }));
+    REQUIRE(job.getStatistics().commands == 4);
+    std::size_t count = 0;
+    REQUIRE(wait_for([&]() {
+      GCodeCommandRecord record;
+      while (job.tryPop(record)) {
+        count++;
+      }
+      return job.isDone();
+    }));
+    REQUIRE(count == 50);
+    REQUIRE(job.getStatistics().stalls > 0);
+  }
+  SECTION("Errors") {
+    auto module = std::make_unique<GCodeIRModule>();
+    module->appendInstruction(GCodeIROpcode::Add);
+    GCodeJobInterpreter interp(*module);
+    GCodeJobScheduler scheduler(1);
+    GCodeScheduledJob &job = scheduler.submit(interp);
+    REQUIRE(wait_for([&]() {
+      return job.isDone();
+    }));
+    REQUIRE(job.getState() == GCodeScheduledJob::State::Failed);
+    REQUIRE(job.getError().has_value());
+  }
+  SECTION("Cancellation") {
+    auto module = make_program(50);
+    GCodeJobInterpreter interp(*module), other(*module);
+    GCodeJobScheduler scheduler(1);
+    GCodeScheduledJob &job = scheduler.submit(interp, 1, 4, 4);
+    REQUIRE(wait_for([&]() {
+      return job.getState() == GCodeScheduledJob::State::Blocked;
+    }));
+    job.cancel();
+    REQUIRE(job.getState() == GCodeScheduledJob::State::Cancelled);
+    REQUIRE_FALSE(job.isDone());
+    GCodeScheduledJob &pending = scheduler.submit(other, 1, 4, 4);
+    scheduler.shutdown();
+    REQUIRE(pending.getState() != GCodeScheduledJob::State::Running);
+    REQUIRE_THROWS(scheduler.submit(other));
+  }
+  SECTION("System scope feedback") {
+    constexpr int64_t Count = 200;
+    GCodeIRModule feedback;
+    for (int64_t i = 0; i < Count; i++) {
+      feedback.appendInstruction(GCodeIROpcode::Prologue);
+      feedback.appendInstruction(GCodeIROpcode::Push, i);
+      feedback.appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('X'));
+      feedback.appendInstruction(GCodeIROpcode::LoadNumbered, 5000L);
+      feedback.appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('Y'));
+      feedback.appendInstruction(GCodeIROpcode::Push, 1L);
+      feedback.appendInstruction(GCodeIROpcode::Syscall, static_cast<int64_t>(GCodeSyscallType::General));
+    }
+    feedback.freeze();
+    GCodeJobInterpreter interp(feedback);
+    interp.getSystemScope().getNumbered().put(5000, -1L);
+    GCodeJobScheduler scheduler(2);
+    GCodeScheduledJob &job = scheduler.submit(interp, 1, 16, 8);
+    int64_t expected = 0;
+    bool consistent = true;
+    REQUIRE(wait_for([&]() {
+      GCodeCommandRecord record;
+      while (job.tryPop(record)) {
+        consistent = consistent && record.get('X') == expected && record.get('Y') == expected - 1;
+        interp.getSystemScope().getNumbered().put(5000, static_cast<int64_t>(record.get('X')));
+        job.complete();
+        expected++;
+      }
+      return job.isDone();
+    }));
+    REQUIRE(job.getState() == GCodeScheduledJob::State::Finished);
+    REQUIRE(consistent);
+    REQUIRE(expected == Count);
+  }
+  SECTION("Release") {
+    auto module = make_program(50);
+    GCodeJobInterpreter done(*module), blocked(*module);
+    GCodeJobScheduler scheduler(1);
+    GCodeScheduledJob &finished = scheduler.submit(done, 1, 64, 16);
+    REQUIRE(wait_for([&]() {
+      return finished.getState() == GCodeScheduledJob::State::Finished;
+    }));
+    scheduler.release(finished);
+    REQUIRE(scheduler.getStatistics().jobs == 1);
+    REQUIRE(scheduler.getStatistics().total.commands == 50);
+    GCodeScheduledJob &pending = scheduler.submit(blocked, 1, 4, 4);
+    REQUIRE(wait_for([&]() {
+      return pending.getState() == GCodeScheduledJob::State::Blocked;
+    }));
+    scheduler.release(pending);
+    GCodeSchedulerStatistics stats = scheduler.getStatistics();
+    REQUIRE(stats.jobs == 2);
+    REQUIRE(stats.total.commands == 54);
+  }
+}
\ No newline at end of file
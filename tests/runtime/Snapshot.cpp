@@ -0,0 +1,187 @@
+#include "gcodelib/Frontend.h"
+#include "gcodelib/runtime/Interpreter.h"
+#include "catch.hpp"
+#include <sstream>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+static const std::string Program = "#<count> = 0\n"
+  "o100 sub\n"
+  "#<idx> = 0\n"
+  "o101 while [#<idx> LT #0]\n"
+  "G1 X#<count> Y#<idx>\n"
+  "#<count> = [#<count> + 1]\n"
+  "#<idx> = [#<idx> + 1]\n"
+  "o101 endwhile\n"
+  "o100 endsub\n"
+  "o100 call [3]\n"
+  "o100 call [4]\n"
+  "G0 Z#<count>\n";
+
+class GCodeSnapshotInterpreter : public GCodeInterpreter {
+ public:
+  using GCodeInterpreter::GCodeInterpreter;
+  using GCodeInterpreter::getState;
+
+  GCodeVariableScope &getSystemScope() override {
+    return this->scope;
+  }
+
+  std::vector<std::string> commands;
+ protected:
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &function, const GCodeScopedDictionary<unsigned char> &args) override {
+    std::stringstream ss;
+    ss << function.asInteger();
+    for (const auto &arg : args) {
+      ss << ' ' << arg.first << arg.second.asFloat();
+    }
+    this->commands.push_back(ss.str());
+  }
+ private:
+  GCodeCascadeVariableScope scope;
+};
+
+static void run_commands(GCodeSnapshotInterpreter &interp, std::size_t count) {
+  while (count-- > 0 && interp.runUntilSyscall() == GCodeExecutionStatus::Yielded) {}
+}
+
+TEST_CASE("Runtime snapshots") {
+  GCodeLinuxCNC linuxcnc;
+  std::stringstream ss(Program);
+  auto module = linuxcnc.compile(ss, "snapshot");
+  GCodeSnapshotInterpreter reference(*module);
+  reference.start();
+  REQUIRE(reference.runFor(GCodeInterpreter::Unbounded) == GCodeExecutionStatus::Finished);
+  REQUIRE(reference.commands.size() == 8);
+
+  SECTION("Checkpointing dry run") {
+    GCodeSnapshotInterpreter interp(*module);
+    REQUIRE_THROWS(interp.snapshot());
+    REQUIRE_THROWS(interp.checkpoint(0));
+    std::vector<GCodeRuntimeSnapshot> checkpoints = interp.checkpoint(3);
+    REQUIRE(interp.commands.empty());
+    REQUIRE(interp.isFinished());
+    REQUIRE(checkpoints.size() == 3);
+    REQUIRE(checkpoints[0].commands == 0);
+    REQUIRE(checkpoints[0].pc == 0);
+    REQUIRE(checkpoints[1].commands == 3);
+    REQUIRE(checkpoints[1].frames.size() == 1);
+    REQUIRE(checkpoints[1].callStack.size() == 1);
+    REQUIRE(checkpoints[2].commands == 6);
+    std::vector<std::string> commands;
+    for (std::size_t i = 0; i < checkpoints.size(); i++) {
+      GCodeSnapshotInterpreter segment(*module);
+      segment.restore(checkpoints[i]);
+      run_commands(segment, i + 1 < checkpoints.size() ? checkpoints[i + 1].commands - checkpoints[i].commands : GCodeInterpreter::Unbounded);
+      commands.insert(commands.end(), segment.commands.begin(), segment.commands.end());
+    }
+    REQUIRE(commands == reference.commands);
+  }
+
+  SECTION("Serialization") {
+    GCodeSnapshotInterpreter interp(*module);
+    std::vector<GCodeRuntimeSnapshot> checkpoints = interp.checkpoint(4);
+    REQUIRE(checkpoints.size() == 2);
+    std::stringstream buffer;
+    checkpoints[1].write(buffer);
+    REQUIRE(buffer.str().size() < checkpoints[1].getFootprint());
+    GCodeRuntimeSnapshot snapshot = GCodeRuntimeSnapshot::read(buffer);
+    REQUIRE(snapshot.pc == checkpoints[1].pc);
+    REQUIRE(snapshot.commands == 4);
+    REQUIRE(snapshot.stack.size() == checkpoints[1].stack.size());
+    REQUIRE(snapshot.callStack == checkpoints[1].callStack);
+    REQUIRE(snapshot.global.numbered->size() == checkpoints[1].global.numbered->size());
+    REQUIRE(snapshot.global.named->size() == checkpoints[1].global.named->size());
+    REQUIRE(snapshot.arguments.size() == checkpoints[1].arguments.size());
+    GCodeSnapshotInterpreter resumed(*module);
+    resumed.restore(snapshot);
+    run_commands(resumed, GCodeInterpreter::Unbounded);
+    REQUIRE(resumed.commands == std::vector<std::string>(reference.commands.begin() + 4, reference.commands.end()));
+
+    std::string image = buffer.str();
+    std::stringstream truncated(image.substr(0, image.size() / 2));
+    REQUIRE_THROWS(GCodeRuntimeSnapshot::read(truncated));
+    std::stringstream garbage("GCIR");
+    REQUIRE_THROWS(GCodeRuntimeSnapshot::read(garbage));
+
+    // Oversized counts must fail on the missing records instead of allocating for them up front
+    std::string header = image.substr(0, sizeof(GCodeRuntimeSnapshot::Magic) + 2 * sizeof(uint16_t));
+    std::string huge("\x80\x80\x80\x08", 4);
+    std::stringstream stack(header + std::string("\0\0", 2) + huge);
+    GCodeAllocationCounter counter;
+    REQUIRE_THROWS_AS(GCodeRuntimeSnapshot::read(stack), GCodeRuntimeError);
+    REQUIRE(counter.getPeakBytes() < (1 << 20));
+    std::stringstream frames(header + std::string(6, '\0') + huge);
+    REQUIRE_THROWS_AS(GCodeRuntimeSnapshot::read(frames), GCodeRuntimeError);
+    std::stringstream key(header + std::string(5, '\0') + std::string("\x01", 1) + huge + "X");
+    REQUIRE_THROWS_AS(GCodeRuntimeSnapshot::read(key), GCodeRuntimeError);
+  }
+
+  SECTION("Restoring a running interpreter") {
+    GCodeSnapshotInterpreter interp(*module);
+    interp.start();
+    run_commands(interp, 2);
+    GCodeRuntimeSnapshot snapshot = interp.snapshot();
+    run_commands(interp, GCodeInterpreter::Unbounded);
+    REQUIRE(interp.isFinished());
+    interp.commands.clear();
+    interp.restore(snapshot);
+    run_commands(interp, GCodeInterpreter::Unbounded);
+    REQUIRE(interp.commands == std::vector<std::string>(reference.commands.begin() + 2, reference.commands.end()));
+  }
+}
+
+TEST_CASE("Snapshot sharing") {
+  GCodeCascadeVariableScope system;
+  GCodeRuntimeState state(system);
+  state.getScope().getNumbered().put(5, 1L);
+  state.getScope().getNamed().put("feed", 100.0);
+  state.push(3L);
+  GCodeRuntimeSnapshot first = state.snapshot();
+  GCodeRuntimeSnapshot second = state.snapshot(&first);
+  REQUIRE(second.global.numbered == first.global.numbered);
+  REQUIRE(second.global.named == first.global.named);
+  state.getScope().getNumbered().put(5, 2L);
+  GCodeRuntimeSnapshot third = state.snapshot(&second);
+  REQUIRE(third.global.numbered != second.global.numbered);
+  REQUIRE(third.global.named == second.global.named);
+
+  system.getNumbered().put(5, 10L);
+  state.restore(first);
+  REQUIRE(state.getScope().getNumbered().get(5).getInteger() == 1);
+  REQUIRE(system.getNumbered().get(5).getInteger() == 10);
+  REQUIRE(state.pop().getInteger() == 3);
+}
+
+TEST_CASE("Interpreter forking") {
+  GCodeLinuxCNC linuxcnc;
+  std::stringstream ss(Program);
+  auto module = linuxcnc.compile(ss, "fork");
+  GCodeSnapshotInterpreter reference(*module);
+  reference.start();
+  REQUIRE(reference.runFor(GCodeInterpreter::Unbounded) == GCodeExecutionStatus::Finished);
+
+  GCodeSnapshotInterpreter interp(*module);
+  GCodeSnapshotInterpreter branch(*module);
+  REQUIRE_THROWS(interp.fork(branch));
+  std::stringstream otherSource("G0 X1\n");
+  auto other = linuxcnc.compile(otherSource, "other");
+  GCodeSnapshotInterpreter stranger(*other);
+  interp.start();
+  REQUIRE_THROWS(interp.fork(stranger));
+  run_commands(interp, 2);
+  interp.fork(branch);
+  REQUIRE(branch.getState().getCallDepth() == 1);
+  branch.getState().getScope().getNamed().put("count", 100L);
+  GCodeSnapshotInterpreter nested(*module);
+  branch.fork(nested);
+  run_commands(branch, GCodeInterpreter::Unbounded);
+  run_commands(interp, GCodeInterpreter::Unbounded);
+  run_commands(nested, 1);
+  REQUIRE(interp.commands == reference.commands);
+  REQUIRE(branch.commands.size() == 6);
+  REQUIRE(branch.commands.front() == "1 X101 Y2");
+  REQUIRE(branch.commands.back() == "0 Z106");
+  REQUIRE(nested.commands == std::vector<std::string>{"1 X101 Y2"});
+}
\ No newline at end of file
@@ -4,11 +4,13 @@
 using namespace GCodeLib::Parser;
 using namespace GCodeLib::Runtime;
 
-bool operator==(const SourcePosition &p1, const SourcePosition &p2) {
-  return p1.getTag().compare(p2.getTag()) == 0 &&
-    p1.getLine() == p2.getLine() &&
-    p1.getColumn() == p2.getColumn() &&
-    p1.getChecksum() == p2.getChecksum();
+namespace GCodeLib::Parser {
+  bool operator==(const SourcePosition &p1, const SourcePosition &p2) {
+    return p1.getTag().compare(p2.getTag()) == 0 &&
+      p1.getLine() == p2.getLine() &&
+      p1.getColumn() == p2.getColumn() &&
+      p1.getChecksum() == p2.getChecksum();
+  }
 }
 
 TEST_CASE("Source block") {
@@ -50,4 +52,47 @@ TEST_CASE("Source map") {
   REQUIRE(l3.has_value());
   REQUIRE(l3.value() == pos[0]);
   REQUIRE_FALSE(l4.has_value());
+}
+
+TEST_CASE("Source map index") {
+  IRSourceMap map;
+  map.addBlock(SourcePosition("main", 1, 1, 0), 0, 20);
+  map.addBlock(SourcePosition("main", 2, 1, 0), 2, 4);
+  map.addBlock(SourcePosition("main", 2, 5, 0), 3, 2);
+  map.addBlock(SourcePosition("main", 3, 1, 0), 8, 4);
+  map.addBlock(SourcePosition("main", 4, 1, 0), 14, 0);
+  map.addBlock(SourcePosition("sub", 1, 1, 0), 30, 5);
+  REQUIRE(map.size() == 6);
+  SECTION("Lookup") {
+    REQUIRE(map.locate(0).value().getLine() == 1);
+    REQUIRE(map.locate(2).value().getLine() == 2);
+    REQUIRE(map.locate(3).value().getColumn() == 5);
+    REQUIRE(map.locate(5).value().getColumn() == 1);
+    REQUIRE(map.locate(6).value().getLine() == 1);
+    REQUIRE(map.locate(11).value().getLine() == 3);
+    REQUIRE(map.locate(14).value().getLine() == 1);
+    REQUIRE_FALSE(map.locate(20).has_value());
+    REQUIRE(map.locate(34).value().getTag() == "sub");
+    REQUIRE_FALSE(map.locate(35).has_value());
+    map.addBlock(SourcePosition("main", 5, 1, 0), 20, 5);
+    REQUIRE(map.locate(20).value().getLine() == 5);
+  }
+  SECTION("Reverse lookup") {
+    REQUIRE(map.findAddress(1).value() == 0);
+    REQUIRE(map.findAddress(2).value() == 2);
+    REQUIRE(map.findAddress(3).value() == 8);
+    REQUIRE_FALSE(map.findAddress(4).has_value());
+    REQUIRE(map.findAddress("sub", 1).value() == 30);
+    REQUIRE_FALSE(map.findAddress("other", 1).has_value());
+  }
+  SECTION("Blocks") {
+    IRSourceBlock block = map.getBlock(1);
+    REQUIRE(block.getStartAddress() == 2);
+    REQUIRE(block.getLength() == 4);
+    REQUIRE(block.getSourcePosition() == SourcePosition("main", 2, 1, 0));
+    IRSourceMap copy(map);
+    REQUIRE(copy.locate(3).value() == map.locate(3).value());
+    REQUIRE(map.getFootprint() > 0);
+    REQUIRE_THROWS(map.addBlock(SourcePosition("main", 1, 1, 0), UINT32_MAX, 2));
+  }
 }
\ No newline at end of file
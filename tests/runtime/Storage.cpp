@@ -47,6 +47,84 @@ TEST_CASE("Scoped dictionary") {
   REQUIRE(child.has('A'));
 }
 
+TEST_CASE("Local dictionary") {
+  GCodeScopedDictionary<int64_t> parent;
+  GCodeLocalDictionary child(&parent);
+  const int64_t Overflow = GCodeLocalDictionary::FixedSlots + 10;
+  REQUIRE(child.getParent() == &parent);
+  REQUIRE_FALSE(child.has(1));
+  REQUIRE(child.get(1).is(Type::None));
+  REQUIRE_NOTHROW(parent.put(1, 100L));
+  REQUIRE(child.has(1));
+  REQUIRE_FALSE(child.hasOwn(1));
+  REQUIRE(child.get(1).getInteger() == 100L);
+  REQUIRE_FALSE(child.put(1, 200L));
+  REQUIRE(parent.get(1).getInteger() == 200L);
+  REQUIRE(child.put(2, 300L));
+  REQUIRE(child.put(Overflow, 400L));
+  REQUIRE(child.put(-1, 500L));
+  REQUIRE(child.hasOwn(2));
+  REQUIRE(child.hasOwn(Overflow));
+  REQUIRE(child.hasOwn(-1));
+  REQUIRE_FALSE(parent.has(2));
+  REQUIRE_FALSE(parent.has(Overflow));
+  REQUIRE(child.get(2).getInteger() == 300L);
+  REQUIRE(child.get(Overflow).getInteger() == 400L);
+  REQUIRE(child.get(-1).getInteger() == 500L);
+  REQUIRE(child.remove(2));
+  REQUIRE_FALSE(child.has(2));
+  REQUIRE(child.remove(1));
+  REQUIRE_FALSE(parent.has(1));
+  REQUIRE_FALSE(child.remove(3));
+  REQUIRE_NOTHROW(parent.put(3, 600L));
+  REQUIRE_NOTHROW(child.clear());
+  REQUIRE_FALSE(child.has(Overflow));
+  REQUIRE_FALSE(child.has(-1));
+  REQUIRE(child.has(3));
+}
+
+TEST_CASE("Dense dictionary") {
+  GCodeScopedDictionary<int64_t> parent;
+  GCodeDenseDictionary child(&parent);
+  const int64_t Sparse = GCodeDenseDictionary::DenseSlots + 10;
+  REQUIRE(child.getParent() == &parent);
+  REQUIRE_FALSE(child.has(5221));
+  REQUIRE(child.get(5221).is(Type::None));
+  REQUIRE_NOTHROW(parent.put(5221, 100L));
+  REQUIRE(child.has(5221));
+  REQUIRE_FALSE(child.hasOwn(5221));
+  REQUIRE_FALSE(child.put(5221, 200L));
+  REQUIRE(parent.get(5221).getInteger() == 200L);
+  REQUIRE(child.put(1, 300L));
+  REQUIRE(child.put(5602, 3.14));
+  REQUIRE(child.put(Sparse, "Hello"));
+  REQUIRE(child.put(-1, 400L));
+  REQUIRE(child.hasOwn(1));
+  REQUIRE(child.hasOwn(5602));
+  REQUIRE(child.hasOwn(Sparse));
+  REQUIRE(child.hasOwn(-1));
+  REQUIRE_FALSE(child.hasOwn(2));
+  REQUIRE_FALSE(parent.has(1));
+  REQUIRE(child.get(1).getInteger() == 300L);
+  REQUIRE(child.get(5602).getFloat() == Approx(3.14));
+  REQUIRE(child.get(Sparse).getString().compare("Hello") == 0);
+  REQUIRE(child.get(-1).getInteger() == 400L);
+  REQUIRE(child.remove(5602));
+  REQUIRE_FALSE(child.has(5602));
+  REQUIRE(child.remove(Sparse));
+  REQUIRE_FALSE(child.has(Sparse));
+  REQUIRE(child.remove(5221));
+  REQUIRE_FALSE(parent.has(5221));
+  REQUIRE_FALSE(child.remove(5221));
+  REQUIRE_NOTHROW(parent.put(2, 500L));
+  REQUIRE_NOTHROW(child.clear());
+  REQUIRE_FALSE(child.has(1));
+  REQUIRE_FALSE(child.has(-1));
+  REQUIRE(child.has(2));
+  REQUIRE(child.put(1, 600L));
+  REQUIRE(child.get(1).getInteger() == 600L);
+}
+
 TEST_CASE("Virtual dictionary") {
   GCodeVirtualDictionary<char> dict;
   REQUIRE_FALSE(dict.has('A'));
@@ -148,4 +226,89 @@ TEST_CASE("Cascade variable scope") {
     REQUIRE(scope2.getNamed().has("abc"));
     REQUIRE(scope2.getNumbered().has(1));
   }
+}
+
+TEST_CASE("Dense variable scope") {
+  GCodeScopedDictionary<int64_t> numbered;
+  GCodeScopedDictionary<std::string> named;
+  GCodeCustomVariableScope scope1(numbered, named);
+  GCodeDenseVariableScope scope2(&scope1);
+  scope1.getNumbered().put(5221, 100L);
+  scope1.getNamed().put("abc", 200L);
+  REQUIRE(scope2.getNumbered().get(5221).getInteger() == 100L);
+  REQUIRE(scope2.getNamed().get("abc").getInteger() == 200L);
+  scope2.getNumbered().put(5061, 300L);
+  scope2.getNamed().put("def", 400L);
+  REQUIRE_FALSE(scope1.getNumbered().has(5061));
+  REQUIRE_FALSE(scope1.getNamed().has("def"));
+  REQUIRE(scope2.getNumbered().get(5061).getInteger() == 300L);
+  REQUIRE(scope2.getNamed().get("def").getInteger() == 400L);
+}
+
+TEST_CASE("Frame variable scope") {
+  GCodeCascadeVariableScope global;
+  GCodeFrameVariableScope frame(&global);
+  global.getNumbered().put(1, 100L);
+  global.getNamed().put("abc", 200L);
+  REQUIRE(frame.getNumbered().get(1).getInteger() == 100L);
+  REQUIRE(frame.getNamed().get("abc").getInteger() == 200L);
+  frame.getNumbered().put(2, 300L);
+  frame.getNamed().put("def", 400L);
+  REQUIRE_FALSE(global.getNumbered().has(2));
+  REQUIRE_FALSE(global.getNamed().has("def"));
+  REQUIRE_NOTHROW(frame.reset());
+  REQUIRE_FALSE(frame.getNumbered().has(2));
+  REQUIRE_FALSE(frame.getNamed().has("def"));
+  REQUIRE(frame.getNumbered().has(1));
+  REQUIRE(frame.getNamed().has("abc"));
+}
+
+TEST_CASE("Copy-on-write dictionaries") {
+  SECTION("Scoped dictionary") {
+    GCodeScopedDictionary<std::string> parent;
+    GCodeScopedDictionary<std::string> original(&parent), copy(&parent);
+    original.put("feed", 100L);
+    copy.copyOwn(original);
+    REQUIRE(copy.get("feed").getInteger() == 100);
+    copy.put("feed", 80L);
+    copy.put("speed", 1L);
+    REQUIRE(original.get("feed").getInteger() == 100);
+    REQUIRE_FALSE(original.has("speed"));
+    original.clear();
+    REQUIRE(copy.get("feed").getInteger() == 80);
+    REQUIRE(copy.getParent() == &parent);
+  }
+  SECTION("Local dictionary") {
+    GCodeLocalDictionary original, copy;
+    original.put(1, 10L);
+    original.put(100, 20L);
+    copy.copyOwn(original);
+    copy.put(100, 30L);
+    copy.remove(1);
+    REQUIRE(original.get(1).getInteger() == 10);
+    REQUIRE(original.get(100).getInteger() == 20);
+    REQUIRE_FALSE(copy.has(1));
+    REQUIRE(copy.get(100).getInteger() == 30);
+  }
+  SECTION("Dense dictionary") {
+    GCodeScopedDictionary<int64_t> system;
+    system.put(5000, 1L);
+    GCodeDenseDictionary original(&system), copy;
+    original.put(100, 1.0);
+    original.put(101, 2.0);
+    original.put(-5, 3.0);
+    copy.copyOwn(original);
+    REQUIRE(copy.getParent() == nullptr);
+    REQUIRE(copy.get(101).getFloat() == 2.0);
+    copy.put(100, 0.8);
+    copy.put(-5, 4.0);
+    REQUIRE(original.get(100).getFloat() == 1.0);
+    REQUIRE(original.get(-5).getFloat() == 3.0);
+    REQUIRE(copy.get(100).getFloat() == 0.8);
+    REQUIRE(copy.get(101).getFloat() == 2.0);
+    original.clear();
+    REQUIRE_FALSE(original.hasOwn(101));
+    REQUIRE(copy.get(101).getFloat() == 2.0);
+    REQUIRE(original.get(5000).getInteger() == 1);
+  }
 }
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "catch.hpp"
+#include "gcodelib/runtime/Syscall.h"
+
+using namespace GCodeLib::Runtime;
+using Type = GCodeRuntimeValue::Type;
+
+TEST_CASE("Syscall arguments") {
+  GCodeSyscallArguments args;
+  REQUIRE(args.getMask() == 0);
+  REQUIRE_FALSE(args.has('X'));
+  REQUIRE(args.get('X') == 0.0);
+  REQUIRE(args.get('X', 1.0) == 1.0);
+  REQUIRE(args.getValue('X').is(Type::None));
+  REQUIRE(args.put('X', 100L));
+  REQUIRE(args.put('F', 3.14));
+  REQUIRE(args.put('A', "Hello"));
+  REQUIRE_FALSE(args.put('a', 1L));
+  REQUIRE_FALSE(args.put('#', 1L));
+  REQUIRE(args.getMask() == (GCodeSyscallArguments::bit('X') | GCodeSyscallArguments::bit('F') | GCodeSyscallArguments::bit('A')));
+  REQUIRE(args.has('X'));
+  REQUIRE(args.has('F'));
+  REQUIRE(args.has('A'));
+  REQUIRE_FALSE(args.has('Y'));
+  REQUIRE_FALSE(args.has('a'));
+  REQUIRE(args.get('X') == Approx(100.0));
+  REQUIRE(args.get('F') == Approx(3.14));
+  REQUIRE(args.get('A') == 0.0);
+  REQUIRE(args.getValue('X').getInteger() == 100L);
+  REQUIRE(args.getValue('F').getFloat() == Approx(3.14));
+  REQUIRE(args.getValue('A').getString().compare("Hello") == 0);
+
+  GCodeScopedDictionary<unsigned char> dict;
+  args.copyTo(dict);
+  REQUIRE(dict.get('X').getInteger() == 100L);
+  REQUIRE(dict.get('F').getFloat() == Approx(3.14));
+  REQUIRE(dict.get('A').getString().compare("Hello") == 0);
+  REQUIRE_FALSE(dict.has('Y'));
+
+  REQUIRE_NOTHROW(args.clear());
+  REQUIRE(args.getMask() == 0);
+  REQUIRE_FALSE(args.has('X'));
+  REQUIRE(args.getValue('X').is(Type::None));
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "catch.hpp"
+#include "gcodelib/runtime/Interpreter.h"
+#include <atomic>
+#include <thread>
+
+using namespace GCodeLib::Runtime;
+
+class GCodeTelemetryInterpreter : public GCodeInterpreter {
+ public:
+  using GCodeInterpreter::GCodeInterpreter;
+
+  GCodeVariableScope &getSystemScope() override {
+    return this->scope;
+  }
+ protected:
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &) override {}
+ private:
+  GCodeCascadeVariableScope scope;
+};
+
+static void build_program(GCodeIRModule &module, std::vector<GCodeLib::Parser::SourcePosition> &positions, int64_t count) {
+  for (int64_t i = 0; i < count; i++) {
+    positions.push_back(GCodeLib::Parser::SourcePosition("telemetry", static_cast<uint32_t>(i + 1), 1, 0));
+  }
+  for (int64_t i = 0; i < count; i++) {
+    auto position = module.newPositionRegister(positions[i]);
+    module.appendInstruction(GCodeIROpcode::Prologue);
+    module.appendInstruction(GCodeIROpcode::Push, i);
+    module.appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('X'));
+    module.appendInstruction(GCodeIROpcode::Push, 1L);
+    module.appendInstruction(GCodeIROpcode::Syscall, static_cast<int64_t>(GCodeSyscallType::General));
+  }
+}
+
+TEST_CASE("Telemetry") {
+  GCodeIRModule module;
+  std::vector<GCodeLib::Parser::SourcePosition> positions;
+  positions.reserve(20000);
+  SECTION("Counters") {
+    build_program(module, positions, 10);
+    GCodeTelemetryInterpreter interp(module);
+    GCodeTelemetry telemetry(module);
+    GCodeTelemetrySnapshot initial = telemetry.read();
+    REQUIRE(initial.instructions == 0);
+    REQUIRE_FALSE(initial.running);
+    REQUIRE_FALSE(initial.position.has_value());
+    interp.setTelemetry(&telemetry);
+    REQUIRE(interp.getTelemetry() == &telemetry);
+    interp.start();
+    REQUIRE(interp.runUntilSyscall() == GCodeExecutionStatus::Yielded);
+    REQUIRE(interp.runUntilSyscall() == GCodeExecutionStatus::Yielded);
+    GCodeTelemetrySnapshot paused = telemetry.read();
+    REQUIRE(paused.instructions == 10);
+    REQUIRE(paused.commands == 2);
+    REQUIRE(paused.address == 9);
+    REQUIRE(paused.callDepth == 0);
+    REQUIRE_FALSE(paused.running);
+    REQUIRE(paused.position.has_value());
+    REQUIRE(paused.position->getLine() == 2);
+    REQUIRE(interp.runFor(GCodeInterpreter::Unbounded) == GCodeExecutionStatus::Finished);
+    REQUIRE(telemetry.getInstructions() == 50);
+    REQUIRE(telemetry.getCommands() == 10);
+    REQUIRE(telemetry.read().position->getLine() == 10);
+
+    GCodeIRModule other;
+    GCodeTelemetry foreign(other);
+    REQUIRE_THROWS(interp.setTelemetry(&foreign));
+    interp.setTracer(nullptr);
+    REQUIRE(interp.getTelemetry() == &telemetry);
+    interp.setTelemetry(nullptr);
+    REQUIRE(interp.getTelemetry() == nullptr);
+  }
+  SECTION("Concurrent reads") {
+    const int64_t Count = 20000;
+    build_program(module, positions, Count);
+    GCodeTelemetryInterpreter interp(module);
+    GCodeTelemetry telemetry(module);
+    interp.setTelemetry(&telemetry);
+    interp.start();
+    std::atomic<bool> done = false;
+    bool consistent = true;
+    bool monotonic = true;
+    std::thread reader([&]() {
+      uint64_t last = 0;
+      while (!done.load()) {
+        GCodeTelemetrySnapshot snapshot = telemetry.read();
+        consistent = consistent && snapshot.instructions >= snapshot.commands * 5 &&
+          snapshot.instructions < snapshot.commands * 5 + 5 &&
+          (snapshot.commands == 0 || snapshot.address == snapshot.commands * 5 - 1);
+        monotonic = monotonic && snapshot.commands >= last;
+        last = snapshot.commands;
+      }
+    });
+    while (interp.runFor(997) == GCodeExecutionStatus::Yielded) {}
+    done = true;
+    reader.join();
+    REQUIRE(consistent);
+    REQUIRE(monotonic);
+    REQUIRE(telemetry.getCommands() == static_cast<uint64_t>(Count));
+  }
+}
\ No newline at end of file
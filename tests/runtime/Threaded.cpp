@@ -0,0 +1,151 @@
+#include "catch.hpp"
+#include "gcodelib/runtime/Threaded.h"
+
+using namespace GCodeLib::Runtime;
+
+class GCodeQueueInterpreter : public GCodeInterpreter {
+ public:
+  using GCodeInterpreter::GCodeInterpreter;
+
+  GCodeVariableScope &getSystemScope() override {
+    return this->scope;
+  }
+ protected:
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &) override {}
+ private:
+  GCodeCascadeVariableScope scope;
+};
+
+static void append_command(GCodeIRModule &module, int64_t x) {
+  module.appendInstruction(GCodeIROpcode::Prologue);
+  module.appendInstruction(GCodeIROpcode::Push, x);
+  module.appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('X'));
+  module.appendInstruction(GCodeIROpcode::Push, 1L);
+  module.appendInstruction(GCodeIROpcode::Syscall, static_cast<int64_t>(GCodeSyscallType::General));
+}
+
+TEST_CASE("SPSC queue") {
+  GCodeSPSCQueue<int> queue(3);
+  int value = 0;
+  REQUIRE(queue.capacity() == 4);
+  REQUIRE(queue.empty());
+  REQUIRE_FALSE(queue.tryPop(value));
+  for (int i = 0; i < 4; i++) {
+    REQUIRE(queue.tryPush(i));
+  }
+  REQUIRE_FALSE(queue.tryPush(4));
+  REQUIRE(queue.size() == 4);
+  for (int i = 0; i < 4; i++) {
+    REQUIRE(queue.tryPop(value));
+    REQUIRE(value == i);
+  }
+  REQUIRE_FALSE(queue.tryPop(value));
+  REQUIRE(queue.empty());
+
+  const int Count = 100000;
+  GCodeSPSCQueue<int> channel(16);
+  std::thread producer([&]() {
+    for (int i = 0; i < Count; i++) {
+      while (!channel.tryPush(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  bool ordered = true;
+  for (int i = 0; i < Count; i++) {
+    while (!channel.tryPop(value)) {
+      std::this_thread::yield();
+    }
+    ordered = ordered && value == i;
+  }
+  producer.join();
+  REQUIRE(ordered);
+}
+
+TEST_CASE("Threaded runner") {
+  const int64_t Count = 1000;
+  GCodeIRModule module;
+  for (int64_t i = 0; i < Count; i++) {
+    append_command(module, i);
+  }
+  GCodeQueueInterpreter interp(module);
+  SECTION("Command stream") {
+    GCodeThreadedRunner runner(interp, 8, 4);
+    REQUIRE_THROWS(runner.pop());
+    runner.start();
+    REQUIRE_THROWS(runner.start());
+    int64_t expected = 0;
+    while (true) {
+      GCodeQueuedCommand cmd = runner.pop();
+      if (cmd.type != GCodeQueuedCommand::Type::Command) {
+        REQUIRE(cmd.type == GCodeQueuedCommand::Type::Finished);
+        break;
+      }
+      REQUIRE(cmd.command.get('X') == expected++);
+    }
+    REQUIRE(expected == Count);
+    REQUIRE_THROWS(runner.pop());
+    runner.stop();
+    REQUIRE_FALSE(runner.isRunning());
+  }
+  SECTION("Errors") {
+    module.appendInstruction(GCodeIROpcode::Add);
+    append_command(module, Count);
+    GCodeThreadedRunner runner(interp, 16, 16);
+    runner.start();
+    int64_t commands = 0;
+    GCodeQueuedCommand cmd;
+    while (true) {
+      if (!runner.tryPop(cmd)) {
+        std::this_thread::yield();
+        continue;
+      }
+      if (cmd.type == GCodeQueuedCommand::Type::Command) {
+        commands++;
+      } else {
+        break;
+      }
+    }
+    REQUIRE(commands == Count);
+    REQUIRE(cmd.type == GCodeQueuedCommand::Type::Error);
+    REQUIRE(cmd.error.has_value());
+  }
+  SECTION("Cancellation") {
+    GCodeThreadedRunner runner(interp, 4, 4);
+    runner.start();
+    REQUIRE(runner.pop().type == GCodeQueuedCommand::Type::Command);
+    REQUIRE_NOTHROW(runner.stop());
+    REQUIRE_FALSE(runner.isRunning());
+  }
+  SECTION("System scope feedback") {
+    GCodeIRModule feedback;
+    for (int64_t i = 0; i < Count; i++) {
+      feedback.appendInstruction(GCodeIROpcode::Prologue);
+      feedback.appendInstruction(GCodeIROpcode::Push, i);
+      feedback.appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('X'));
+      feedback.appendInstruction(GCodeIROpcode::LoadNumbered, 5000L);
+      feedback.appendInstruction(GCodeIROpcode::SetArg, static_cast<int64_t>('Y'));
+      feedback.appendInstruction(GCodeIROpcode::Push, 1L);
+      feedback.appendInstruction(GCodeIROpcode::Syscall, static_cast<int64_t>(GCodeSyscallType::General));
+    }
+    GCodeQueueInterpreter machine(feedback);
+    machine.getSystemScope().getNumbered().put(5000, -1L);
+    GCodeThreadedRunner runner(machine, 16, 8);
+    runner.start();
+    int64_t expected = 0;
+    bool consistent = true;
+    while (true) {
+      GCodeQueuedCommand cmd = runner.pop();
+      if (cmd.type != GCodeQueuedCommand::Type::Command) {
+        REQUIRE(cmd.type == GCodeQueuedCommand::Type::Finished);
+        break;
+      }
+      consistent = consistent && cmd.command.get('X') == expected && cmd.command.get('Y') == expected - 1;
+      machine.getSystemScope().getNumbered().put(5000, static_cast<int64_t>(cmd.command.get('X')));
+      runner.complete();
+      expected++;
+    }
+    REQUIRE(consistent);
+    REQUIRE(expected == Count);
+  }
+}
\ No newline at end of file
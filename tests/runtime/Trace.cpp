@@ -0,0 +1,176 @@
+#include "gcodelib/Frontend.h"
+#include "gcodelib/runtime/Interpreter.h"
+#include "catch.hpp"
+#include <sstream>
+
+using namespace GCodeLib;
+using namespace GCodeLib::Runtime;
+
+static const std::string Program = "#<feed> = 100\n"
+  "o100 sub\n"
+  "#<feed> = [#<feed> * #0]\n"
+  "G1 X#0 F100\n"
+  "o100 endsub\n"
+  "o100 call [1]\n"
+  "o100 call [2]\n"
+  "#5 = #<feed>\n"
+  "G0 Z#5\n";
+
+class GCodeTracedInterpreter : public GCodeInterpreter {
+ public:
+  using GCodeInterpreter::GCodeInterpreter;
+
+  GCodeVariableScope &getSystemScope() override {
+    return this->scope;
+  }
+ protected:
+  void syscall(GCodeSyscallType, const GCodeRuntimeValue &, const GCodeScopedDictionary<unsigned char> &) override {}
+ private:
+  GCodeCascadeVariableScope scope;
+};
+
+class GCodeCountingTracer : public GCodeTracer {
+ public:
+  void instruction(std::size_t, const GCodeIRInstruction &) override {
+    this->instructions++;
+  }
+
+  void syscall(std::size_t, GCodeSyscallType, const GCodeRuntimeValue &, const GCodeSyscallArguments &) override {
+    this->syscalls++;
+  }
+
+  std::size_t instructions = 0;
+  std::size_t syscalls = 0;
+};
+
+static std::size_t count_events(const std::vector<GCodeTraceEvent> &events, GCodeTraceEventType type) {
+  return std::count_if(events.begin(), events.end(), [&](const GCodeTraceEvent &event) {
+    return event.type == type;
+  });
+}
+
+TEST_CASE("Interpreter tracing") {
+  GCodeLinuxCNC linuxcnc;
+  std::stringstream ss(Program);
+  auto module = linuxcnc.compile(ss, "trace");
+  GCodeTracedInterpreter interp(*module);
+  GCodeProfiler profiler(*module);
+  interp.setProfiler(&profiler);
+  interp.start();
+  interp.runFor(GCodeInterpreter::Unbounded);
+  const uint64_t Instructions = profiler.getInstructions();
+  interp.setProfiler(nullptr);
+
+  SECTION("Ring buffer") {
+    GCodeRingBufferTracer all(6);
+    REQUIRE(all.getCapacity() == 8);
+    interp.setTracer(&all);
+    REQUIRE(interp.getProfiler() == nullptr);
+    interp.start();
+    interp.runFor(GCodeInterpreter::Unbounded);
+    std::vector<GCodeTraceEvent> events = all.getEvents();
+    REQUIRE(events.size() == 8);
+    REQUIRE(all.getRecorded() > Instructions);
+    REQUIRE(events.back().type == GCodeTraceEventType::Syscall);
+    REQUIRE(events.back().code == static_cast<uint8_t>(GCodeSyscallType::General));
+
+    GCodeRingBufferTracer control(64, GCodeTraceEvent::Control);
+    interp.setTracer(&control);
+    interp.start();
+    interp.runFor(GCodeInterpreter::Unbounded);
+    events = control.getEvents();
+    REQUIRE(count_events(events, GCodeTraceEventType::Instruction) == 0);
+    REQUIRE(count_events(events, GCodeTraceEventType::Syscall) == 5);
+    REQUIRE(count_events(events, GCodeTraceEventType::Call) == 2);
+    REQUIRE(count_events(events, GCodeTraceEventType::Ret) == 2);
+    REQUIRE(count_events(events, GCodeTraceEventType::StoreNumbered) == 1);
+    REQUIRE(count_events(events, GCodeTraceEventType::StoreNamed) == 3);
+    auto store = std::find_if(events.begin(), events.end(), [](const GCodeTraceEvent &event) {
+      return event.type == GCodeTraceEventType::StoreNumbered;
+    });
+    REQUIRE(store->operand == 5);
+    REQUIRE(store->value == 200.0);
+    REQUIRE(store->depth == 0);
+    auto call = std::find_if(events.begin(), events.end(), [](const GCodeTraceEvent &event) {
+      return event.type == GCodeTraceEventType::Call;
+    });
+    REQUIRE(call->operand == 100);
+    REQUIRE(call[1].depth == 1);
+    control.clear();
+    REQUIRE(control.getEvents().empty());
+  }
+
+  SECTION("Binary file") {
+    std::stringstream trace;
+    {
+      GCodeFileTracer file(trace, GCodeTraceEvent::Control, 4);
+      interp.setTracer(&file);
+      interp.start();
+      REQUIRE(interp.runUntilSyscall() == GCodeExecutionStatus::Yielded);
+      REQUIRE(trace.str().size() > sizeof(GCodeFileTracer::Magic));
+      interp.runFor(GCodeInterpreter::Unbounded);
+      REQUIRE(file.getRecorded() == 13);
+      interp.setTracer(nullptr);
+    }
+    std::vector<GCodeTraceEvent> events = GCodeFileTracer::read(trace);
+    REQUIRE(events.size() == 13);
+    REQUIRE(count_events(events, GCodeTraceEventType::Syscall) == 5);
+    std::string image = trace.str();
+    std::stringstream truncated(image.substr(0, image.size() - 3));
+    REQUIRE_THROWS(GCodeFileTracer::read(truncated));
+    std::stringstream garbage("GCIR0000");
+    REQUIRE_THROWS(GCodeFileTracer::read(garbage));
+  }
+
+  SECTION("Failing trace file") {
+    GCodeIRModule broken;
+    broken.appendInstruction(GCodeIROpcode::Push, 1L);
+    broken.appendInstruction(GCodeIROpcode::Add);
+    GCodeTracedInterpreter failing(broken);
+    std::stringstream trace;
+    GCodeFileTracer file(trace, GCodeTraceEvent::All);
+    trace.setstate(std::ios::badbit);
+    failing.setTracer(&file);
+    failing.start();
+    REQUIRE(failing.runFor(GCodeInterpreter::Unbounded) == GCodeExecutionStatus::Error);
+    REQUIRE(failing.getError().has_value());
+    REQUIRE(std::string(failing.getError()->what()) != "Unable to write trace events");
+    failing.setTracer(nullptr);
+  }
+
+  SECTION("Custom tracer") {
+    GCodeCountingTracer counter;
+    interp.setTracer(&counter);
+    interp.start();
+    interp.runFor(GCodeInterpreter::Unbounded);
+    REQUIRE(counter.instructions == Instructions);
+    REQUIRE(counter.syscalls == 5);
+    interp.setTracer(nullptr);
+    interp.start();
+    interp.runFor(GCodeInterpreter::Unbounded);
+    REQUIRE(counter.instructions == Instructions);
+  }
+
+  SECTION("Composed tracers") {
+    GCodeCountingTracer counter;
+    GCodeCoverage coverage(*module);
+    profiler.reset();
+    interp.setProfiler(&profiler);
+    interp.setCoverage(&coverage);
+    interp.setTracer(&counter);
+    interp.start();
+    interp.runFor(GCodeInterpreter::Unbounded);
+    REQUIRE(profiler.getInstructions() == Instructions);
+    REQUIRE(counter.instructions == Instructions);
+    REQUIRE(counter.syscalls == 5);
+    REQUIRE(coverage.getBitmap().count() > 0);
+    interp.setCoverage(nullptr);
+    interp.setTracer(nullptr);
+    REQUIRE(interp.getProfiler() == &profiler);
+    REQUIRE(interp.getCoverage() == nullptr);
+    interp.start();
+    interp.runFor(GCodeInterpreter::Unbounded);
+    REQUIRE(profiler.getInstructions() == 2 * Instructions);
+    REQUIRE(counter.instructions == Instructions);
+  }
+}
\ No newline at end of file
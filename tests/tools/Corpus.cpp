@@ -0,0 +1,37 @@
+#include "gcodelib/Frontend.h"
+#include "catch.hpp"
+#include "Corpus.h"
+#include <sstream>
+
+using namespace GCodeLib;
+
+template <typename Frontend>
+static std::size_t compile_corpus(const GCodeCorpus::Generator::Kind &kind, const GCodeCorpus::Options &options) {
+  std::stringstream program;
+  kind.fn(program, options);
+  Frontend frontend;
+  auto module = frontend.compile(program, kind.name);
+  return module->length();
+}
+
+TEST_CASE("Corpus generator") {
+  GCodeCorpus::Options options;
+  options.seed = 7;
+  options.lines = 200;
+  options.depth = 4;
+  options.width = 256;
+  for (const auto &kind : GCodeCorpus::Generator::kinds()) {
+    SECTION(kind.name) {
+      REQUIRE(GCodeCorpus::Generator::find(kind.name) == &kind);
+      std::stringstream first, second;
+      kind.fn(first, options);
+      kind.fn(second, options);
+      REQUIRE(first.str() == second.str());
+      std::size_t length = kind.name.compare("reprap") == 0
+        ? compile_corpus<GCodeRepRap>(kind, options)
+        : compile_corpus<GCodeLinuxCNC>(kind, options);
+      REQUIRE(length > 0);
+    }
+  }
+  REQUIRE(GCodeCorpus::Generator::find("unknown") == nullptr);
+}
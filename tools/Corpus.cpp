@@ -0,0 +1,421 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "Corpus.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace GCodeCorpus {
+
+  Random::Random(uint64_t seed)
+    : state(seed) {}
+
+  uint64_t Random::next() {
+    uint64_t z = (this->state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  std::size_t Random::uniform(std::size_t bound) {
+    return bound > 0 ? static_cast<std::size_t>(this->next() % bound) : 0;
+  }
+
+  int64_t Random::range(int64_t min, int64_t max) {
+    return min + static_cast<int64_t>(this->uniform(static_cast<std::size_t>(max - min + 1)));
+  }
+
+  bool Random::chance(unsigned int percent) {
+    return this->uniform(100) < percent;
+  }
+
+  // Fixed-point formatting keeps the output independent of the locale and of floating point printing
+  static std::string decimal(int64_t scaled, unsigned int digits) {
+    int64_t unit = 1;
+    for (unsigned int i = 0; i < digits; i++) {
+      unit *= 10;
+    }
+    std::string fraction = std::to_string((scaled < 0 ? -scaled : scaled) % unit);
+    fraction.insert(0, digits - fraction.size(), '0');
+    return (scaled < 0 ? "-" : "") + std::to_string((scaled < 0 ? -scaled : scaled) / unit) + "." + fraction;
+  }
+
+  void generateRepRap(std::ostream &os, const Options &options) {
+    Random random(options.seed);
+    os << "; generated by gcodecorpus, seed " << options.seed << '\n'
+      << "M104 S210\n"
+      << "M140 S60\n"
+      << "G28 ; home all axes\n"
+      << "G21\n"
+      << "G90\n"
+      << "M82\n"
+      << "M109 S210\n"
+      << "G92 E0\n";
+    std::size_t lines = 8;
+    int64_t extruded = 0;
+    int64_t x = 100000, y = 100000;
+    for (std::size_t layer = 0; lines < options.lines; layer++) {
+      os << ";LAYER:" << layer << '\n'
+        << "G0 F7200 Z" << decimal(200 + static_cast<int64_t>(layer) * 200, 3) << '\n';
+      lines += 2;
+      std::size_t segments = 50 + random.uniform(200);
+      for (std::size_t segment = 0; segment < segments && lines < options.lines; segment++) {
+        if (random.chance(5)) {
+          extruded -= 1000;
+          x = random.range(20000, 180000);
+          y = random.range(20000, 180000);
+          os << "G1 F2400 E" << decimal(extruded, 5) << '\n'
+            << "G0 F7200 X" << decimal(x, 3) << " Y" << decimal(y, 3) << '\n';
+          extruded += 1000;
+          os << "G1 F2400 E" << decimal(extruded, 5) << '\n';
+          lines += 3;
+          continue;
+        }
+        int64_t dx = random.range(-5000, 5000), dy = random.range(-5000, 5000);
+        x = std::clamp<int64_t>(x + dx, 0, 200000);
+        y = std::clamp<int64_t>(y + dy, 0, 200000);
+        extruded += (std::abs(dx) + std::abs(dy)) * 33 / 1000 + 1;
+        os << "G1";
+        if (segment == 0 || random.chance(10)) {
+          os << " F" << (random.chance(50) ? 1800 : 1200);
+        }
+        os << " X" << decimal(x, 3) << " Y" << decimal(y, 3) << " E" << decimal(extruded, 5);
+        if (random.chance(3)) {
+          os << " ; " << (random.chance(50) ? "perimeter" : "infill");
+        }
+        os << '\n';
+        lines++;
+      }
+    }
+  }
+
+  class LinuxCNCWriter {
+   public:
+    LinuxCNCWriter(std::ostream &os, const Options &options)
+      : os(os), options(options), random(options.seed), lines(0), label(1000) {}
+
+    void generate() {
+      this->os << "(generated by gcodecorpus, seed " << this->options.seed << ")\n";
+      this->lines++;
+      this->procedures();
+      for (std::size_t i = 0; i < Variables; i++) {
+        this->os << "#<var" << i << "> = " << decimal(this->random.range(-10000, 10000), 3) << '\n'
+          << '#' << (i + 1) << " = " << this->random.range(1, 100) << '\n';
+        this->lines += 2;
+      }
+      while (this->lines < this->options.lines) {
+        this->statement(0);
+      }
+      this->os << "o" << (ProcedureBase + this->levels() - 1) << " call [1] [2]\n"
+        << "M2\n";
+    }
+   private:
+    static constexpr std::size_t Variables = 8;
+    static constexpr std::size_t ProcedureBase = 100;
+    static constexpr std::size_t ProcedureLoopBase = 200;
+
+    std::size_t levels() const {
+      return std::max<std::size_t>(1, std::min<std::size_t>(this->options.depth, 100));
+    }
+
+    void procedures() {
+      this->os << "o" << ProcedureBase << " sub\n"
+        << "#<px> = [#0 * 0.5 + #1]\n"
+        << "#<py> = [[#0 MOD 37] * 0.25]\n"
+        << "G1 X#<px> Y#<py> F1200\n"
+        << "o" << ProcedureBase << " endsub\n";
+      this->lines += 5;
+      for (std::size_t level = 1; level < this->levels(); level++) {
+        this->os << "o" << (ProcedureBase + level) << " sub\n"
+          << "o" << (ProcedureLoopBase + level) << " repeat [2]\n"
+          << "o" << (ProcedureBase + level - 1) << " call [[#0 + 1]] [[#1 * 0.5]]\n"
+          << "o" << (ProcedureLoopBase + level) << " endrepeat\n"
+          << "o" << (ProcedureBase + level) << " endsub\n";
+        this->lines += 5;
+      }
+    }
+
+    void variable() {
+      if (this->random.chance(60)) {
+        this->os << "#<var" << this->random.uniform(Variables) << '>';
+      } else {
+        this->os << '#' << (this->random.uniform(Variables) + 1);
+      }
+    }
+
+    void expression(std::size_t depth) {
+      if (depth == 0 || this->random.chance(25)) {
+        if (this->random.chance(50)) {
+          this->variable();
+        } else if (this->random.chance(50)) {
+          this->os << this->random.range(0, 1000);
+        } else {
+          this->os << decimal(this->random.range(0, 100000), 3);
+        }
+        return;
+      }
+      switch (this->random.uniform(8)) {
+        case 0:
+          this->os << '[';
+          this->expression(depth - 1);
+          this->os << " / [ABS[";
+          this->expression(depth - 1);
+          this->os << "] + 1]]";
+          break;
+        case 1:
+          this->os << '[';
+          this->expression(depth - 1);
+          this->os << " MOD " << this->random.range(1, 97) << ']';
+          break;
+        case 2:
+          this->os << (this->random.chance(50) ? "SIN[" : "COS[");
+          this->expression(depth - 1);
+          this->os << ']';
+          break;
+        case 3:
+          this->os << "SQRT[ABS[";
+          this->expression(depth - 1);
+          this->os << "]]";
+          break;
+        default: {
+          static const char *Operators[] = { " + ", " - ", " * ", " + " };
+          this->os << '[';
+          this->expression(depth - 1);
+          this->os << Operators[this->random.uniform(4)];
+          this->expression(depth - 1);
+          this->os << ']';
+        } break;
+      }
+    }
+
+    void condition() {
+      static const char *Comparisons[] = { " LT ", " GT ", " LE ", " GE ", " EQ ", " NE " };
+      this->os << '[';
+      this->variable();
+      this->os << Comparisons[this->random.uniform(6)];
+      this->expression(2);
+      this->os << ']';
+    }
+
+    void block(std::size_t depth) {
+      std::size_t count = 1 + this->random.uniform(4);
+      for (std::size_t i = 0; i < count; i++) {
+        this->statement(depth + 1);
+      }
+    }
+
+    void statement(std::size_t depth) {
+      bool nested = depth < std::min<std::size_t>(this->options.depth, 3);
+      std::size_t choice = this->random.uniform(nested ? 10 : 6);
+      std::size_t label = this->label++;
+      switch (choice) {
+        case 0:
+        case 1:
+          this->os << "#<var" << this->random.uniform(Variables) << "> = ";
+          this->expression(4);
+          this->os << '\n';
+          this->lines++;
+          break;
+        case 2:
+          this->os << '#' << (this->random.uniform(Variables) + 1) << " = ";
+          this->expression(3);
+          this->os << '\n';
+          this->lines++;
+          break;
+        case 3:
+        case 4:
+          this->os << "G1 X[";
+          this->expression(2);
+          this->os << "] Y[";
+          this->expression(2);
+          this->os << "] F" << (this->random.chance(50) ? 1800 : 600) << '\n';
+          this->lines++;
+          break;
+        case 5:
+          this->os << "o" << (ProcedureBase + this->random.uniform(std::min<std::size_t>(this->levels(), 4))) << " call [";
+          this->expression(2);
+          this->os << "] [";
+          this->expression(2);
+          this->os << "]\n";
+          this->lines++;
+          break;
+        case 6:
+          this->os << "#<cnt" << label << "> = 0\n"
+            << "o" << label << " while [#<cnt" << label << "> LT " << this->random.range(1, 8) << "]\n";
+          this->lines += 2;
+          this->block(depth);
+          this->os << "#<cnt" << label << "> = [#<cnt" << label << "> + 1]\n"
+            << "o" << label << " endwhile\n";
+          this->lines += 2;
+          break;
+        case 7:
+          this->os << "o" << label << " repeat [" << this->random.range(1, 8) << "]\n";
+          this->lines++;
+          this->block(depth);
+          this->os << "o" << label << " endrepeat\n";
+          this->lines++;
+          break;
+        default:
+          this->os << "o" << label << " if ";
+          this->condition();
+          this->os << '\n';
+          this->lines++;
+          this->block(depth);
+          if (this->random.chance(50)) {
+            this->os << "o" << label << " else\n";
+            this->lines++;
+            this->block(depth);
+          }
+          this->os << "o" << label << " endif\n";
+          this->lines++;
+          break;
+      }
+    }
+
+    std::ostream &os;
+    const Options &options;
+    Random random;
+    std::size_t lines;
+    std::size_t label;
+  };
+
+  void generateLinuxCNC(std::ostream &os, const Options &options) {
+    LinuxCNCWriter(os, options).generate();
+  }
+
+  void generateLongLines(std::ostream &os, const Options &options) {
+    Random random(options.seed);
+    os << "(generated by gcodecorpus, seed " << options.seed << ")\n";
+    for (std::size_t line = 1; line < options.lines; line++) {
+      std::size_t length = 0;
+      if (line % 2 == 0) {
+        os << "#<sum> = [0";
+        for (; length < options.width; length += 8) {
+          os << " + " << decimal(random.range(0, 99999), 3);
+        }
+        os << "]\n";
+      } else {
+        os << "G1 X" << decimal(random.range(0, 200000), 3) << " Y" << decimal(random.range(0, 200000), 3) << " F1800 (";
+        for (; length < options.width; length++) {
+          os << static_cast<char>('a' + random.uniform(26));
+        }
+        os << ")\n";
+      }
+    }
+  }
+
+  void generateDeepNesting(std::ostream &os, const Options &options) {
+    enum class Structure { Repeat, Conditional, Loop };
+    std::size_t depth = std::max<std::size_t>(options.depth, 1);
+    Random random(options.seed);
+    os << "(generated by gcodecorpus, seed " << options.seed << ")\n";
+    for (std::size_t level = 0; level < depth; level++) {
+      os << "o" << (100 + level) << " sub\n";
+      if (level == 0) {
+        os << "G1 X#0 Y#1 F1800\n";
+      } else {
+        os << "o" << (99 + level) << " call [[#0 + 1]] [#1]\n";
+      }
+      os << "o" << (100 + level) << " endsub\n";
+    }
+    std::size_t lines = 1 + depth * 3;
+    std::size_t label = 100 + depth;
+    std::vector<Structure> structures;
+    while (lines < options.lines) {
+      structures.clear();
+      for (std::size_t level = 0; level < depth; level++) {
+        std::size_t id = label + level;
+        structures.push_back(static_cast<Structure>(random.uniform(3)));
+        switch (structures.back()) {
+          case Structure::Repeat:
+            os << "o" << id << " repeat [1]\n";
+            break;
+          case Structure::Conditional:
+            os << "o" << id << " if [" << level << " LT " << depth << "]\n";
+            break;
+          case Structure::Loop:
+            os << "#<flag" << id << "> = 0\n"
+              << "o" << id << " while [#<flag" << id << "> LT 1]\n"
+              << "#<flag" << id << "> = 1\n";
+            lines += 2;
+            break;
+        }
+      }
+      os << "o" << (99 + depth) << " call [0] [" << random.range(0, 1000) << "]\n";
+      for (std::size_t level = depth; level-- > 0;) {
+        std::size_t id = label + level;
+        switch (structures[level]) {
+          case Structure::Repeat:
+            os << "o" << id << " endrepeat\n";
+            break;
+          case Structure::Conditional:
+            os << "o" << id << " endif\n";
+            break;
+          case Structure::Loop:
+            os << "o" << id << " endwhile\n";
+            break;
+        }
+      }
+      lines += 2 * depth + 1;
+      label += depth;
+    }
+  }
+
+  void generateDeepExpressions(std::ostream &os, const Options &options) {
+    std::size_t depth = std::max<std::size_t>(options.depth, 1);
+    Random random(options.seed);
+    os << "(generated by gcodecorpus, seed " << options.seed << ")\n";
+    for (std::size_t line = 1; line < options.lines; line++) {
+      os << "#<expr> = ";
+      if (line % 2 == 0) {
+        for (std::size_t i = 0; i < depth; i++) {
+          os << '[';
+        }
+        os << random.range(0, 9);
+        for (std::size_t i = 0; i < depth; i++) {
+          os << (random.chance(50) ? " + " : " * ") << random.range(1, 9) << ']';
+        }
+      } else {
+        for (std::size_t i = 0; i < depth; i++) {
+          os << '[' << random.range(1, 9) << (random.chance(50) ? " - " : " + ");
+        }
+        os << random.range(0, 9);
+        for (std::size_t i = 0; i < depth; i++) {
+          os << ']';
+        }
+      }
+      os << '\n';
+    }
+  }
+
+  const std::vector<Generator::Kind> &Generator::kinds() {
+    static const std::vector<Kind> Kinds = {
+      { "reprap", "RepRap slicer-like output: layers of G1 moves with E/F, retractions and comments", generateRepRap },
+      { "linuxcnc", "LinuxCNC program with nested o-sub calls, loops, conditionals, named and numbered parameters", generateLinuxCNC },
+      { "long-lines", "LinuxCNC lines of about --width characters: flat sums and long comments", generateLongLines },
+      { "deep-nesting", "LinuxCNC control structures and call chains nested --depth levels deep", generateDeepNesting },
+      { "deep-expressions", "LinuxCNC expressions with brackets nested --depth levels deep", generateDeepExpressions }
+    };
+    return Kinds;
+  }
+
+  const Generator::Kind *Generator::find(const std::string &name) {
+    for (const auto &kind : Generator::kinds()) {
+      if (kind.name.compare(name) == 0) {
+        return &kind;
+      }
+    }
+    return nullptr;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#ifndef GCODELIB_TOOLS_CORPUS_H_
+#define GCODELIB_TOOLS_CORPUS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace GCodeCorpus {
+
+  struct Options {
+    uint64_t seed = 1;
+    std::size_t lines = 100000;
+    std::size_t depth = 8;
+    std::size_t width = 4096;
+  };
+
+  // SplitMix64: the standard distributions are implementation-defined, so
+  // sequences are derived from raw integers to stay identical across platforms
+  class Random {
+   public:
+    Random(uint64_t);
+    uint64_t next();
+    std::size_t uniform(std::size_t);
+    int64_t range(int64_t, int64_t);
+    bool chance(unsigned int);
+   private:
+    uint64_t state;
+  };
+
+  class Generator {
+   public:
+    using Fn = void (*)(std::ostream &, const Options &);
+
+    struct Kind {
+      std::string name;
+      std::string description;
+      Fn fn;
+    };
+
+    static const std::vector<Kind> &kinds();
+    static const Kind *find(const std::string &);
+  };
+
+  void generateRepRap(std::ostream &, const Options &);
+  void generateLinuxCNC(std::ostream &, const Options &);
+  void generateLongLines(std::ostream &, const Options &);
+  void generateDeepNesting(std::ostream &, const Options &);
+  void generateDeepExpressions(std::ostream &, const Options &);
+}
+
+#endif
\ No newline at end of file
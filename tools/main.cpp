@@ -0,0 +1,85 @@
+/*
+  SPDX short identifier: MIT
+  Copyright 2019 Jevgēnijs Protopopovs
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+#include "Corpus.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+using namespace GCodeCorpus;
+
+static void usage(const char *program) {
+  std::cout << "Usage: " << program << " KIND [--seed N] [--lines N] [--depth N] [--width N] [--output FILE]" << std::endl
+    << "Kinds:" << std::endl;
+  for (const auto &kind : Generator::kinds()) {
+    std::cout << "  " << kind.name << "\t" << kind.description << std::endl;
+  }
+}
+
+int main(int argc, const char **argv) {
+  if (argc < 2) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  const Generator::Kind *kind = Generator::find(argv[1]);
+  if (kind == nullptr) {
+    std::cout << "Unknown corpus kind '" << argv[1] << "'" << std::endl;
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  Options options;
+  std::string output;
+  for (int i = 2; i + 1 < argc; i += 2) {
+    std::string option(argv[i]);
+    std::string value(argv[i + 1]);
+    try {
+      if (option.compare("--seed") == 0) {
+        options.seed = std::stoull(value);
+      } else if (option.compare("--lines") == 0) {
+        options.lines = std::stoull(value);
+      } else if (option.compare("--depth") == 0) {
+        options.depth = std::stoull(value);
+      } else if (option.compare("--width") == 0) {
+        options.width = std::stoull(value);
+      } else if (option.compare("--output") == 0) {
+        output = value;
+      } else {
+        std::cout << "Unknown option '" << option << "'" << std::endl;
+        return EXIT_FAILURE;
+      }
+    } catch (const std::logic_error &) {
+      std::cout << "Invalid value '" << value << "' for " << option << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (argc % 2 != 0) {
+    std::cout << "Missing value for " << argv[argc - 1] << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (output.empty()) {
+    kind->fn(std::cout, options);
+  } else {
+    std::ofstream os(output);
+    if (!os) {
+      std::cout << "Unable to open '" << output << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+    kind->fn(os, options);
+    os.close();
+    if (!os) {
+      std::cout << "Unable to write '" << output << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
\ No newline at end of file